@@ -10,14 +10,13 @@
   SWEEP start_frequency stop_frequency step_in_mS(1-32767) power_level(1-4) aux_power_level(0-4) aux_frequency_output(DIVIDED/FUNDAMENTAL) - sweep RF frequency
   STEP frequency_in_Hz - set channel step
   STATUS - view status of VFO
-  CE (ON/OFF) - enable/disable ADF4351
+  CE (ON/OFF) - resume/standby ADF4351 on the same frequency - ON waits for lock detect and shows the wake to lock time
   CP_CURRENT current_in_mA_floating - adjust charge pump current to suit your loop filter (default library value is 2.5 mA)
   PD_POLARITY (INVERTING/NONINVERTING) - change phase detector polarity (default library is noninverting for passive/noninverting loop filters)
 
 */
 
 #include <ADF4351.h>
-#include <BigNumber.h> // obtain at https://github.com/nickgammon/BigNumber
 
 ADF4351 vfo;
 
@@ -26,7 +25,7 @@ const byte SSpin = 10; // LE
 const byte LockPin = 12; // MISO
 const byte CEpin = 9;
 
-const word SweepSteps = 14; // SweepSteps * 4 * 6 is the temporary memory calculation (remember to leave enough for BigNumber)
+const word SweepSteps = 14; // SweepSteps * 4 * 5 is the temporary memory calculation
 
 const int CommandSize = 50;
 char Command[CommandSize];
@@ -90,6 +89,29 @@ void getField (char* buffer, int index) {
   buffer[FieldPos] = '\0';
 }
 
+uint64_t StringToFrequency(const char* buffer) { // integer Hz - decimal places are ignored
+  uint64_t value = 0;
+  for (int ch = 0; buffer[ch] >= '0' && buffer[ch] <= '9'; ch++) {
+    value *= 10;
+    value += (buffer[ch] - '0');
+  }
+  return value;
+}
+
+void FrequencyToString(uint64_t value, char* buffer) {
+  char temp[20];
+  byte Digits = 0;
+  do { // digits are in reverse order
+    temp[Digits] = ('0' + (value % 10));
+    value /= 10;
+    Digits++;
+  } while (value != 0);
+  for (byte ch = 0; ch < Digits; ch++) {
+    buffer[ch] = temp[(Digits - ch - 1)];
+  }
+  buffer[Digits] = '\0';
+}
+
 void PrintVFOstatus() {
   Serial.print(F("R: "));
   Serial.println(vfo.ReadR());
@@ -191,6 +213,27 @@ void PrintErrorCode(byte value) {
     case ADF4351_ERROR_PFD_LIMITS:
       Serial.println(F("PFD frequency is out of range"));
       break;
+    case ADF4351_ERROR_POLARITY_INVALID:
+      Serial.println(F("Phase detector polarity is incorrect"));
+      break;
+    case ADF4351_WARNING_PRECISION_CALCULATION_INCOMPLETE:
+      Serial.println(F("Precision frequency calculation incomplete"));
+      break;
+    case ADF4351_ERROR_PRECISION_CALCULATION_NOT_STARTED:
+      Serial.println(F("Precision frequency calculation not started"));
+      break;
+    case ADF4351_ERROR_CALIBRATION_TABLE:
+      Serial.println(F("Calibration table is invalid"));
+      break;
+    case ADF4351_ERROR_LOCK_PIN_NOT_USED:
+      Serial.println(F("Lock pin is not used"));
+      break;
+    case ADF4351_ERROR_LOCK_TIMEOUT:
+      Serial.println(F("Lock detect timeout"));
+      break;
+    case ADF4351_ERROR_HOP_NOT_PREPARED:
+      Serial.println(F("Next hop frequency not prepared"));
+      break;
   }
 }
 
@@ -400,11 +443,10 @@ void loop() {
         }
       }
       else if (strcmp(field, "SWEEP") == 0) {
-        BigNumber::begin(12); // will finish on setf()
         getField(field, 1);
-        BigNumber BN_StartFrequency(field);
+        uint64_t StartFrequency = StringToFrequency(field);
         getField(field, 2);
-        BigNumber BN_StopFrequency(field);
+        uint64_t StopFrequency = StringToFrequency(field);
         getField(field, 3);
         word SweepStepTime = atoi(field);
         getField(field, 4);
@@ -423,59 +465,21 @@ void loop() {
           ValidField = false;
         }
         if (ValidField == true) {
-          if (BN_StartFrequency < BN_StopFrequency) {
-            char tmpstr[12];
-            ultoa(vfo.ADF4351_ChanStep, tmpstr, 10);
-            char tmpstr2[12];
-            ultoa(SweepSteps, tmpstr2, 10);
-            BigNumber BN_StepSize = ((BN_StopFrequency - BN_StartFrequency) / (BigNumber(tmpstr2)) - BigNumber("1"));
-            if (BN_StepSize >= BigNumber(tmpstr)) {
-              BigNumber BN_StepSizeRounding = (BN_StepSize / BigNumber(tmpstr));
-              uint32_t StepSizeRounding = (uint32_t)((uint32_t) BN_StepSizeRounding);
-              ultoa(StepSizeRounding, tmpstr2, 10);
-              BN_StepSize = (BigNumber(tmpstr) * BigNumber(tmpstr2));
-              char StepSize[14];
-              char StartFrequency[14];
-              char* tempstring1 = BN_StepSize.toString();
-              for (int i = 0; i < 14; i++) {
-                byte temp = tempstring1[i];
-                if (temp == '.') {
-                  StepSize[i] = 0x00;
-                  break;
-                }
-                StepSize[i] = temp;
-              }
-              free(tempstring1);
-              char* tempstring2 = BN_StartFrequency.toString();
-              BigNumber::finish();
-              for (int i = 0; i < 14; i++) {
-                byte temp = tempstring2[i];
-                if (temp == '.') {
-                  StepSize[i] = 0x00;
-                  break;
-                }
-                StartFrequency[i] = temp;
-              }
-              free(tempstring2);
+          if (StartFrequency < StopFrequency) {
+            // step size is ((stop - start) / steps) - 1 rounded down to a multiple of the channel step
+            uint64_t StepSize = 0;
+            if ((StopFrequency - StartFrequency) >= (SweepSteps * (vfo.ADF4351_ChanStep + 1ULL))) {
+              StepSize = (((StopFrequency - StartFrequency) - SweepSteps) / (SweepSteps * (uint64_t)vfo.ADF4351_ChanStep));
+              StepSize *= vfo.ADF4351_ChanStep;
+            }
+            if (StepSize != 0) {
               uint32_t regs[(ADF4351_RegsToWrite * SweepSteps)];
               uint32_t reg_temp[ADF4351_RegsToWrite];
               for (word SweepCount = 0; SweepCount < SweepSteps; SweepCount++) {
                 Serial.print(F("Calculating step "));
                 Serial.print(SweepCount);
                 char CurrentFrequency[14];
-                BigNumber::begin(12);
-                BigNumber BN_CurrentFrequency = (BigNumber(StartFrequency) + (BigNumber(StepSize) * BigNumber(SweepCount)));
-                char* tempstring3 = BN_CurrentFrequency.toString();
-                BigNumber::finish();
-                for (int y = 0; y < 14; y++) {
-                  byte temp = tempstring3[y];
-                  if (temp == '.') {
-                    CurrentFrequency[y] = 0x00;
-                    break;
-                  }
-                  CurrentFrequency[y] = temp;
-                }
-                free(tempstring3);
+                FrequencyToString((StartFrequency + (StepSize * SweepCount)), CurrentFrequency);
                 Serial.print(F(" - frequency is now "));
                 Serial.print(CurrentFrequency);
                 Serial.println(F(" Hz"));
@@ -515,20 +519,15 @@ void loop() {
               }
             }
             else {
-              BigNumber::finish();
               Serial.println(F("Calculated frequency step is smaller than preset frequency step"));
               ValidField = false;
             }
           }
           else {
-            BigNumber::finish();
             Serial.println(F("Stop frequency must be greater than start frequency"));
             ValidField = false;
           }
         }
-        else {
-          BigNumber::finish();
-        }
       }
       else if (strcmp(field, "STEP") == 0) {
         getField(field, 1);
@@ -553,10 +552,18 @@ void loop() {
       else if (strcmp(field, "CE") == 0) {
         getField(field, 1);
         if (strcmp(field, "ON") == 0) {
-          digitalWrite(CEpin, HIGH);
+          byte ErrorCode = vfo.resume(true, 100000UL);
+          if (ErrorCode != ADF4351_ERROR_NONE) {
+            ValidField = false;
+            PrintErrorCode(ErrorCode);
+          }
+          else {
+            Serial.print(F("Wake to lock time (uS): "));
+            Serial.println(vfo.ReadWakeToLockTime());
+          }
         }
         else if (strcmp(field, "OFF") == 0) {
-          digitalWrite(CEpin, LOW);
+          vfo.standby();
         }
         else {
           ValidField = false;
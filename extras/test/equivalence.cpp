@@ -0,0 +1,149 @@
+// Regenerates the register values for random and edge case frequencies and compares them line by line
+// with equivalence_reference.txt, which was generated by the pre v1.2.0 library built against a long double
+// emulation of BigNumber rather than the BigNumber library itself (see the header of the file)
+//
+// As this is only a floating point stand-in for BigNumber, each result is also checked against exact integer
+// arithmetic from the registers: INT/FRAC/MOD must be in range, the current frequency must be the programmed
+// frequency rounded to ADF4351_DECIMAL_PLACES and the frequency error must be the programmed frequency minus
+// the requested frequency rounded as per setf (and 0 if setf did not return a warning without the precision
+// frequency calculation)
+#include <ADF4351.h>
+#include <random>
+
+struct ReferenceConfiguration {
+  uint32_t ReferenceFrequency;
+  uint16_t R;
+  uint8_t RefDivisor;
+  uint32_t StepFrequency;
+};
+
+static FILE *Reference;
+static uint32_t Lines = 0;
+static uint32_t Mismatches = 0;
+static uint32_t ExactChecks = 0;
+static uint32_t ExactFailures = 0;
+
+static void ExactFailure(const char *freq, const char *Reason) {
+  ExactFailures++;
+  if (ExactFailures <= 10) {
+    printf("%s: %s\n", freq, Reason);
+  }
+}
+
+static void CheckExact(ADF4351 &vfo, const char *freq, int ErrorCode, bool PrecisionFrequency, uint32_t MaximumFrequencyError) {
+  if ((ErrorCode != ADF4351_ERROR_NONE && ErrorCode != ADF4351_WARNING_FREQUENCY_ERROR) || strchr(freq, '.') != NULL) {
+    return;
+  }
+  ExactChecks++;
+  uint64_t Frequency = strtoull(freq, NULL, 10);
+  uint32_t N_Int = vfo.ReadInt();
+  uint32_t Mod = vfo.ReadMod();
+  uint32_t Frac = vfo.ReadFraction();
+  uint32_t MinimumN_Int = (BitFieldManipulation.ReadBF_dword(27, 1, vfo.ADF4351_R[0x01]) != 0) ? 75 : 23; // prescaler 8/9 or 4/5
+  if (Mod < 2 || Mod > 4095 || Frac >= Mod || N_Int < MinimumN_Int) {
+    ExactFailure(freq, "INT/FRAC/MOD out of range");
+    return;
+  }
+  // output frequency is Numerator / Denominator
+  unsigned __int128 Numerator = ((unsigned __int128)vfo.ADF4351_reffreq * (1 + vfo.ReadRefDoubler()) * (((uint64_t)N_Int * Mod) + Frac));
+  unsigned __int128 Denominator = ((unsigned __int128)(1 + vfo.ReadRDIV2()) * vfo.ReadR() * Mod * vfo.ReadOutDivider());
+  unsigned __int128 Scale = 1;
+  for (int i = 0; i < ADF4351_DECIMAL_PLACES; i++) {
+    Scale *= 10;
+  }
+  unsigned __int128 Rounded = (((2 * Numerator * Scale) + Denominator) / (2 * Denominator));
+  char Expected[40];
+  snprintf(Expected, sizeof(Expected), "%llu.%0*llu", (unsigned long long)(Rounded / Scale), ADF4351_DECIMAL_PLACES, (unsigned long long)(Rounded % Scale));
+  char CurrentFrequency[ADF4351_ReadCurrentFrequency_ArraySize];
+  vfo.ReadCurrentFrequency(CurrentFrequency);
+  if (strcmp(CurrentFrequency, Expected) != 0) {
+    ExactFailure(freq, "current frequency is not the programmed frequency");
+  }
+  __int128 Error = ((__int128)Numerator - ((__int128)Frequency * Denominator)); // in units of 1 / Denominator Hz
+  Error = (((2 * Error) + (__int128)Denominator) / (2 * (__int128)Denominator)); // + 0.5 Hz truncated towards zero
+  if (ErrorCode == ADF4351_ERROR_NONE) {
+    if (Error < 0) { // setf leaves a magnitude when within tolerance
+      Error = -Error;
+    }
+    if (Error > ((PrecisionFrequency == true) ? MaximumFrequencyError : 0)) {
+      ExactFailure(freq, "frequency error is out of tolerance without a warning");
+    }
+  }
+  if (Error != vfo.ADF4351_FrequencyError) {
+    ExactFailure(freq, "frequency error does not match the programmed frequency");
+  }
+}
+
+static void Compare(const char *Line) {
+  char Expected[160];
+  Lines++;
+  do { // lines starting with # are comments
+    if (fgets(Expected, sizeof(Expected), Reference) == NULL) {
+      Expected[0] = 0;
+    }
+  } while (Expected[0] == '#');
+  if (strcmp(Line, Expected) != 0) {
+    Mismatches++;
+    if (Mismatches <= 10) {
+      printf("line %u\n  expected %s  actual   %s", Lines, Expected, Line);
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  Reference = fopen((argc > 1) ? argv[1] : "equivalence_reference.txt", "r");
+  if (Reference == NULL) {
+    printf("equivalence: reference file not found\n");
+    return 1;
+  }
+  std::mt19937_64 Random(12345);
+  const ReferenceConfiguration Configuration[] = {
+    {10000000, 1, ADF4351_REF_UNDIVIDED, 100000}, {25000000, 1, ADF4351_REF_UNDIVIDED, 1000}, {10000000, 1, ADF4351_REF_DOUBLE, 1},
+    {100000000, 4, ADF4351_REF_UNDIVIDED, 5000}, {50000000, 2, ADF4351_REF_HALF, 12500}, {30000000, 3, ADF4351_REF_UNDIVIDED, 10000}, {26000000, 1, ADF4351_REF_UNDIVIDED, 1000}
+  };
+  char Line[160];
+  for (const ReferenceConfiguration &c : Configuration) {
+    for (int k = 0; k < 300; k++) {
+      ADF4351 vfo;
+      vfo.setrf(c.ReferenceFrequency, c.R, c.RefDivisor);
+      vfo.SetStepFreq(c.StepFrequency);
+      uint64_t Frequency;
+      if (k % 3 == 0) { // off step
+        Frequency = 34375000ULL + Random() % (4400000000ULL - 34375000ULL);
+      }
+      else { // on step
+        Frequency = (34375000ULL / c.StepFrequency + 1 + Random() % ((4400000000ULL - 34375000ULL) / c.StepFrequency)) * c.StepFrequency;
+      }
+      char freq[24];
+      snprintf(freq, sizeof(freq), "%llu", (unsigned long long)Frequency);
+      bool PrecisionFrequency = (k % 5 == 0);
+      uint32_t FrequencyTolerance = (k % 2) ? 0 : 10;
+      int ErrorCode = vfo.setf(freq, 4, 2, 1, PrecisionFrequency, FrequencyTolerance, 0);
+      char CurrentFrequency[ADF4351_ReadCurrentFrequency_ArraySize];
+      vfo.ReadCurrentFrequency(CurrentFrequency);
+      snprintf(Line, sizeof(Line), "%u %u %u %llu p%d e%d err%ld %08x %08x %08x %08x %08x %s\n", c.ReferenceFrequency, c.R, c.StepFrequency, (unsigned long long)Frequency, PrecisionFrequency, ErrorCode, (long)vfo.ADF4351_FrequencyError, vfo.ADF4351_R[0], vfo.ADF4351_R[1], vfo.ADF4351_R[2], vfo.ADF4351_R[3], vfo.ADF4351_R[4], CurrentFrequency);
+      Compare(Line);
+      CheckExact(vfo, freq, ErrorCode, PrecisionFrequency, FrequencyTolerance);
+    }
+  }
+  const char *EdgeFrequency[] = {"34375000", "34374999.9", "4400000000", "4400000000.5", "3600000000", "3600000001", "2200000000", "2199999999", "1100000000", "68750000", "68749999"};
+  for (const char *f : EdgeFrequency) {
+    for (int PrecisionFrequency = 0; PrecisionFrequency < 2; PrecisionFrequency++) {
+      ADF4351 vfo;
+      vfo.SetStepFreq(1);
+      char freq[24];
+      strcpy(freq, f);
+      int ErrorCode = vfo.setf(freq, 1, 0, 0, PrecisionFrequency, 0, 0);
+      snprintf(Line, sizeof(Line), "%s p%d e%d err%ld %08x %08x %08x\n", f, PrecisionFrequency, ErrorCode, (long)vfo.ADF4351_FrequencyError, vfo.ADF4351_R[0], vfo.ADF4351_R[1], vfo.ADF4351_R[4]);
+      Compare(Line);
+      CheckExact(vfo, freq, ErrorCode, PrecisionFrequency, 0);
+    }
+  }
+  if (fgets(Line, sizeof(Line), Reference) != NULL) {
+    Mismatches++;
+    printf("reference has more than %u lines\n", Lines);
+  }
+  fclose(Reference);
+  printf("equivalence: %u lines, %u mismatches, %u exact checks, %u failures\n", Lines, Mismatches, ExactChecks, ExactFailures);
+  return (Mismatches == 0 && ExactFailures == 0) ? 0 : 1;
+}
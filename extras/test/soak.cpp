@@ -0,0 +1,90 @@
+// Retunes millions of times through setf, the precision calculation and sweep values while counting
+// heap allocations - the library must not allocate after init
+#include <ADF4351.h>
+#include <new>
+
+static unsigned long Allocations = 0;
+
+extern "C" {
+  void *__real_malloc(size_t Size);
+  void *__real_calloc(size_t Count, size_t Size);
+  void *__real_realloc(void *Pointer, size_t Size);
+
+  void *__wrap_malloc(size_t Size) {
+    Allocations++;
+    return __real_malloc(Size);
+  }
+  void *__wrap_calloc(size_t Count, size_t Size) {
+    Allocations++;
+    return __real_calloc(Count, Size);
+  }
+  void *__wrap_realloc(void *Pointer, size_t Size) {
+    Allocations++;
+    return __real_realloc(Pointer, Size);
+  }
+}
+
+void *operator new(size_t Size) {
+  Allocations++;
+  void *Pointer = __real_malloc(Size);
+  if (Pointer == NULL) {
+    throw std::bad_alloc();
+  }
+  return Pointer;
+}
+void *operator new[](size_t Size) {
+  return operator new(Size);
+}
+void operator delete(void *Pointer) noexcept {
+  free(Pointer);
+}
+void operator delete[](void *Pointer) noexcept {
+  free(Pointer);
+}
+
+#define SOAK_RETUNES 2000000UL
+
+int main() {
+  ADF4351 vfo;
+  vfo.init(10, 12, true, 9, true);
+  vfo.setrf(25000000, 1, ADF4351_REF_UNDIVIDED);
+  vfo.SetStepFreq(1000);
+  char freq[24];
+  char CurrentFrequency[ADF4351_ReadCurrentFrequency_ArraySize];
+  uint32_t regs[ADF4351_RegsToWrite];
+  uint32_t Errors = 0;
+  uint32_t Warnings = 0; // 1 kHz steps cannot all be obtained exactly with MOD <= 4095 without the precision calculation
+  unsigned long AllocationsBefore = Allocations;
+  for (uint32_t i = 0; i < SOAK_RETUNES; i++) {
+    snprintf(freq, sizeof(freq), "%lu", 35000000UL + (i % 4000000UL) * 1000UL);
+    int ErrorCode;
+    if (i % 1000 == 0) { // precision calculation in steps
+      ErrorCode = vfo.setfPrecisionStart(freq, 4, 0, 0, 0);
+      while (ErrorCode == ADF4351_ERROR_NONE && vfo.setfPrecisionBusy() == true) {
+        if (vfo.setfPrecisionStep(64) != ADF4351_WARNING_PRECISION_CALCULATION_INCOMPLETE) {
+          break;
+        }
+      }
+      if (ErrorCode == ADF4351_ERROR_NONE) {
+        ErrorCode = vfo.setfPrecisionCommit();
+      }
+    }
+    else if (i % 4 == 0) {
+      ErrorCode = vfo.CalculateSweepValues(freq, 4, 0, 0, regs);
+      vfo.WriteSweepValuesChanged(regs);
+    }
+    else {
+      ErrorCode = vfo.setf(freq, 4, 0, 0, (i % 100) == 0, 0, 0);
+    }
+    if (ErrorCode == ADF4351_WARNING_FREQUENCY_ERROR) {
+      Warnings++;
+    }
+    else if (ErrorCode != ADF4351_ERROR_NONE) {
+      Errors++;
+    }
+    vfo.ReadCurrentFrequency(CurrentFrequency);
+  }
+  unsigned long SoakAllocations = (Allocations - AllocationsBefore);
+  printf("soak: %lu retunes, %u errors, %u frequency error warnings, %lu heap allocations, %u register writes, last frequency %s\n", SOAK_RETUNES, Errors, Warnings, SoakAllocations, StubRegisterWrites, CurrentFrequency);
+  return (SoakAllocations == 0 && Errors == 0) ? 0 : 1;
+}
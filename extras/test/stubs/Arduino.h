@@ -0,0 +1,44 @@
+// host stub of the Arduino core for extras/test - time only advances with simulated SPI writes and pin reads
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+typedef uint16_t word;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define OUTPUT 1
+#define INPUT 0
+#define INPUT_PULLUP 2
+#define MSBFIRST 1
+
+extern unsigned long StubMicros;
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) {
+  StubMicros++;
+  return HIGH;
+}
+inline unsigned long millis() {
+  return (StubMicros / 1000);
+}
+inline unsigned long micros() {
+  return StubMicros;
+}
+inline void delayMicroseconds(unsigned int us) {
+  StubMicros += us;
+}
+inline void delay(unsigned long ms) {
+  StubMicros += (ms * 1000);
+}
+inline char *ultoa(unsigned long value, char *s, int) {
+  sprintf(s, "%lu", value);
+  return s;
+}
+
+#endif
@@ -0,0 +1,16 @@
+// host stub of the BeyondByte library for extras/test - register writes are counted rather than sent
+#ifndef BEYONDBYTE_STUB_H
+#define BEYONDBYTE_STUB_H
+#include <stdint.h>
+
+#define BeyondByte_SPI 1
+
+class BeyondByteClass {
+  public:
+    void writeDword(int, uint32_t, int, int, int);
+};
+
+extern BeyondByteClass BeyondByte;
+extern uint32_t StubRegisterWrites;
+
+#endif
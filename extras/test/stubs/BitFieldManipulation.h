@@ -0,0 +1,24 @@
+// host stub of the BitFieldManipulation library for extras/test (dword functions used by the ADF4351 library only)
+#ifndef BITFIELDMANIPULATION_STUB_H
+#define BITFIELDMANIPULATION_STUB_H
+#include <stdint.h>
+
+class BitFieldManipulationClass {
+  public:
+    uint32_t ReadBF_dword(uint8_t BitStart, uint8_t BitWidth, uint32_t Value) {
+      return ((Value >> BitStart) & Mask(BitWidth));
+    }
+    uint32_t WriteBF_dword(uint8_t BitStart, uint8_t BitWidth, uint32_t Value, uint32_t Data) {
+      uint32_t FieldMask = (Mask(BitWidth) << BitStart);
+      return ((Value & ~FieldMask) | ((Data << BitStart) & FieldMask));
+    }
+
+  private:
+    uint32_t Mask(uint8_t BitWidth) {
+      return ((BitWidth >= 32) ? 0xFFFFFFFFUL : ((1UL << BitWidth) - 1));
+    }
+};
+
+extern BitFieldManipulationClass BitFieldManipulation;
+
+#endif
@@ -0,0 +1,27 @@
+// host stub of the Arduino SPI library for extras/test
+#ifndef SPI_STUB_H
+#define SPI_STUB_H
+#include <Arduino.h>
+
+#define SPI_MODE0 0
+
+class SPISettings {
+  public:
+    SPISettings() {}
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+  public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t) {
+      return 0;
+    }
+};
+
+extern SPIClass SPI;
+
+#endif
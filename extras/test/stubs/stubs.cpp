@@ -0,0 +1,15 @@
+#include <Arduino.h>
+#include <SPI.h>
+#include <BitFieldManipulation.h>
+#include <BeyondByte.h>
+
+unsigned long StubMicros = 0;
+uint32_t StubRegisterWrites = 0;
+SPIClass SPI;
+BitFieldManipulationClass BitFieldManipulation;
+BeyondByteClass BeyondByte;
+
+void BeyondByteClass::writeDword(int, uint32_t, int, int, int) {
+  StubRegisterWrites++;
+  StubMicros += 4; // 32 bits at 8 MHz plus overhead
+}
@@ -36,7 +36,7 @@
 
    @section dependencies Dependencies
 
-   This library uses the BigNumber library from Nick Gammon
+   Frequency calculations use exact 64 bit integer arithmetic with no heap memory
    Requires the BitFieldManipulation library: http://github.com/brycecherry75/BitFieldManipulation
    Requires the BeyondByte library: http://github.com/brycecherry75/BeyondByte
 
@@ -47,6 +47,9 @@
 */
 
 #include "ADF4351.h"
+#ifndef ARDUINO
+#include <stdio.h>
+#endif
 
 ADF4351::ADF4351() {
   SPISettings ADF4351_SPI(10000000UL, MSBFIRST, SPI_MODE0);
@@ -54,17 +57,21 @@ ADF4351::ADF4351() {
 
 void ADF4351::WriteRegs() {
   for (int i = 5 ; i >= 0 ; i--) { // sequence according to the ADF4351 datasheet
-    SPI.beginTransaction(ADF4351_SPI);
-    digitalWrite(ADF4351_PIN_SS, LOW);
-    delayMicroseconds(1);
-    BeyondByte.writeDword(0, ADF4351_R[i], 4, BeyondByte_SPI, MSBFIRST);
-    delayMicroseconds(1);
-    digitalWrite(ADF4351_PIN_SS, HIGH);
-    SPI.endTransaction();
-    delayMicroseconds(1);
+    WriteRegister(i);
   }
 }
 
+void ADF4351::WriteRegister(uint8_t reg) {
+  SPI.beginTransaction(ADF4351_SPI);
+  digitalWrite(ADF4351_PIN_SS, LOW);
+  delayMicroseconds(1);
+  BeyondByte.writeDword(0, ADF4351_R[reg], 4, BeyondByte_SPI, MSBFIRST);
+  delayMicroseconds(1);
+  digitalWrite(ADF4351_PIN_SS, HIGH);
+  SPI.endTransaction();
+  delayMicroseconds(1);
+}
+
 void ADF4351::WriteSweepValues(const uint32_t *regs) {
   for (int i = 0; i < ADF4351_RegsToWrite; i++) {
     ADF4351_R[i] = regs[i];
@@ -78,6 +85,281 @@ void ADF4351::ReadSweepValues(uint32_t *regs) {
   }
 }
 
+void ADF4351::WriteSweepValuesChanged(const uint32_t *regs) {
+  for (int i = (ADF4351_RegsToWrite - 1); i > 0; i--) { // only registers which differ from those last written
+    if (ADF4351_R[i] != regs[i]) {
+      ADF4351_R[i] = regs[i];
+      WriteRegister(i);
+    }
+  }
+  ADF4351_R[0] = regs[0];
+  WriteRegister(0); // always written last as it updates the double buffered RF divider and begins VCO band selection
+}
+
+int ADF4351::CalculateSweepValues(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, uint32_t *regs) {
+  uint32_t PreviousRegs[6];
+  for (int i = 0; i < 6; i++) {
+    PreviousRegs[i] = ADF4351_R[i];
+  }
+  int32_t PreviousFrequencyError = ADF4351_FrequencyError;
+  int ErrorCode = CalculateFrequency(freq, PowerLevel, AuxPowerLevel, AuxFrequencyDivider, false);
+  ReadSweepValues(regs);
+  regs[0x02] = BitFieldManipulation.WriteBF_dword(5, 1, regs[0x02], 0); // not powered down on playback if calculated during standby
+  for (int i = 0; i < 6; i++) { // the ADF4351 has not been written to
+    ADF4351_R[i] = PreviousRegs[i];
+  }
+  ADF4351_FrequencyError = PreviousFrequencyError;
+  return ErrorCode;
+}
+
+uint32_t ADF4351::SweepTransitionCost(const uint32_t *FromRegs, const uint32_t *ToRegs) {
+  uint32_t Cost = ADF4351_SWEEP_COST_REGISTER; // R0 is always written
+  for (uint8_t i = 1; i < ADF4351_RegsToWrite; i++) {
+    if (FromRegs[i] != ToRegs[i]) {
+      Cost += ADF4351_SWEEP_COST_REGISTER;
+    }
+  }
+  if (BitFieldManipulation.ReadBF_dword(20, 3, FromRegs[0x04]) != BitFieldManipulation.ReadBF_dword(20, 3, ToRegs[0x04]) || BitFieldManipulation.ReadBF_dword(27, 1, FromRegs[0x01]) != BitFieldManipulation.ReadBF_dword(27, 1, ToRegs[0x01])) {
+    Cost += ADF4351_SWEEP_COST_DIVIDER_CHANGE;
+  }
+  else if (BitFieldManipulation.ReadBF_dword(15, 16, FromRegs[0x00]) != BitFieldManipulation.ReadBF_dword(15, 16, ToRegs[0x00])) { // the VCO moves by at least one PFD step when INT changes, so a new VCO band is modelled - within the same INT, only FRAC changes the VCO by less than one PFD step
+    Cost += ADF4351_SWEEP_COST_BAND_CHANGE;
+  }
+  return Cost;
+}
+
+uint32_t ADF4351::SweepCost(const uint32_t *regs, uint16_t Points) {
+  uint32_t Cost = 0;
+  for (uint16_t Point = 0; Point < Points; Point++) { // the sweep repeats, so the first point follows the last point
+    uint16_t PreviousPoint = Point;
+    if (PreviousPoint == 0) {
+      PreviousPoint = Points;
+    }
+    PreviousPoint--;
+    Cost += SweepTransitionCost(&regs[(PreviousPoint * ADF4351_RegsToWrite)], &regs[(Point * ADF4351_RegsToWrite)]);
+  }
+  return Cost;
+}
+
+void ADF4351::ScheduleSweep(uint32_t *regs, uint16_t Points, uint16_t *Order, uint32_t *CostBefore, uint32_t *CostAfter) {
+  for (uint16_t Point = 0; Point < Points; Point++) {
+    Order[Point] = Point;
+  }
+  *CostBefore = SweepCost(regs, Points);
+  // group points by prescaler and RF divider so that each is changed as few times as possible, then by R0 (INT then FRAC) within each group so that each INT (modelled VCO band) is visited once, with R1-R4 breaking ties
+  SortSweep(regs, Points, Order, true);
+  uint32_t SortedCost = SweepCost(regs, Points);
+  // improve on the sorted order by always visiting the point with the lowest transition cost next, which brings together points with the same MOD, Int-N/Frac-N mode and power level
+  for (uint16_t Point = 1; Point < Points; Point++) {
+    const uint32_t *Previous = &regs[((Point - 1) * ADF4351_RegsToWrite)];
+    uint16_t NearestPoint = Point;
+    uint32_t NearestCost = SweepTransitionCost(Previous, &regs[(Point * ADF4351_RegsToWrite)]);
+    for (uint16_t Candidate = (Point + 1); Candidate < Points; Candidate++) { // ties are kept in sorted order
+      uint32_t Cost = SweepTransitionCost(Previous, &regs[(Candidate * ADF4351_RegsToWrite)]);
+      if (Cost < NearestCost) {
+        NearestCost = Cost;
+        NearestPoint = Candidate;
+      }
+    }
+    SwapSweepPoints(regs, Order, Point, NearestPoint);
+  }
+  *CostAfter = SweepCost(regs, Points);
+  if (*CostAfter > SortedCost) {
+    SortSweep(regs, Points, Order, true);
+    *CostAfter = SortedCost;
+  }
+  if (*CostAfter > *CostBefore) { // keep the original order
+    SortSweep(regs, Points, Order, false);
+    *CostAfter = *CostBefore;
+  }
+}
+
+int ADF4351::CompileLeveledSweep(char **freqs, uint16_t Points, const ADF4351_CalibrationPoint *Calibration, uint16_t CalibrationPoints, uint8_t AuxFrequencyDivider, uint32_t *regs) {
+  if (CalibrationPoints == 0) {
+    return ADF4351_ERROR_CALIBRATION_TABLE;
+  }
+  for (uint16_t Point = 0; Point < CalibrationPoints; Point++) { // as per ReadCalibration for tables which have not been read with it
+    if (Calibration[Point].PowerLevel > 4 || Calibration[Point].AuxPowerLevel > 4) {
+      return ADF4351_ERROR_CALIBRATION_TABLE;
+    }
+    if (Point > 0 && Calibration[Point].Frequency_kHz <= Calibration[(Point - 1)].Frequency_kHz) { // must be in ascending order of frequency
+      return ADF4351_ERROR_CALIBRATION_TABLE;
+    }
+  }
+  for (uint16_t Point = 0; Point < Points; Point++) {
+    uint32_t Frequency_kHz = 0;
+    for (uint8_t i = 0; freqs[Point][i] >= '0' && freqs[Point][i] <= '9'; i++) { // integer kHz - decimal places are ignored
+      if (i >= 3) {
+        Frequency_kHz *= 10;
+        Frequency_kHz += (freqs[Point][(i - 3)] - '0');
+      }
+    }
+    uint8_t PowerLevel;
+    uint8_t AuxPowerLevel;
+    InterpolatePowerLevel(Frequency_kHz, Calibration, CalibrationPoints, &PowerLevel, &AuxPowerLevel);
+    int ErrorCode = CalculateSweepValues(freqs[Point], PowerLevel, AuxPowerLevel, AuxFrequencyDivider, &regs[(Point * ADF4351_RegsToWrite)]);
+    if (ErrorCode != ADF4351_ERROR_NONE) {
+      return ErrorCode;
+    }
+  }
+  return ADF4351_ERROR_NONE;
+}
+
+void ADF4351::InterpolatePowerLevel(uint32_t Frequency_kHz, const ADF4351_CalibrationPoint *Calibration, uint16_t CalibrationPoints, uint8_t *PowerLevel, uint8_t *AuxPowerLevel) {
+  if (CalibrationPoints == 0) { // no calibration table - outputs disabled
+    *PowerLevel = 0;
+    *AuxPowerLevel = 0;
+    return;
+  }
+  uint16_t Upper = 0;
+  while (Upper < CalibrationPoints && Calibration[Upper].Frequency_kHz < Frequency_kHz) {
+    Upper++;
+  }
+  if (Upper == 0 || Upper == CalibrationPoints) { // outside the calibration table - use the nearest point
+    if (Upper == CalibrationPoints) {
+      Upper--;
+    }
+    *PowerLevel = Calibration[Upper].PowerLevel;
+    *AuxPowerLevel = Calibration[Upper].AuxPowerLevel;
+    return;
+  }
+  const ADF4351_CalibrationPoint *Low = &Calibration[(Upper - 1)];
+  const ADF4351_CalibrationPoint *High = &Calibration[Upper];
+  uint32_t Span = (High->Frequency_kHz - Low->Frequency_kHz);
+  uint32_t Offset = (Frequency_kHz - Low->Frequency_kHz);
+  *PowerLevel = InterpolateLevel(Low->PowerLevel, High->PowerLevel, Span, Offset);
+  *AuxPowerLevel = InterpolateLevel(Low->AuxPowerLevel, High->AuxPowerLevel, Span, Offset);
+}
+
+uint8_t ADF4351::InterpolateLevel(uint8_t LowLevel, uint8_t HighLevel, uint32_t Span, uint32_t Offset) {
+  if (LowLevel == 0 || HighLevel == 0) { // 0 disables the output and is not a power step, so use the nearest point
+    if (Offset <= (Span - Offset)) {
+      return LowLevel;
+    }
+    return HighLevel;
+  }
+  // linear interpolation rounded to the nearest power level - power levels are 1-4 so there is no overflow with a frequency span of up to 4.4 GHz in kHz
+  return (((((uint32_t)LowLevel * (Span - Offset)) + ((uint32_t)HighLevel * Offset)) + (Span / 2)) / Span);
+}
+
+int ADF4351::ReadCalibration(const uint8_t *data, uint32_t DataSize, ADF4351_CalibrationPoint *Calibration, uint16_t MaximumCalibrationPoints, uint16_t *CalibrationPoints) {
+  *CalibrationPoints = 0;
+  if (DataSize < ADF4351_CALIBRATION_HEADER_SIZE) {
+    return ADF4351_ERROR_CALIBRATION_TABLE;
+  }
+  uint16_t Points = DecodeCalibrationHeader(data, MaximumCalibrationPoints);
+  if (Points == 0 || DataSize < (ADF4351_CALIBRATION_HEADER_SIZE + ((uint32_t)Points * ADF4351_CALIBRATION_POINT_SIZE))) {
+    return ADF4351_ERROR_CALIBRATION_TABLE;
+  }
+  for (uint16_t Point = 0; Point < Points; Point++) {
+    if (DecodeCalibrationPoint(&data[(ADF4351_CALIBRATION_HEADER_SIZE + ((uint32_t)Point * ADF4351_CALIBRATION_POINT_SIZE))], Calibration, Point) == false) {
+      return ADF4351_ERROR_CALIBRATION_TABLE;
+    }
+  }
+  *CalibrationPoints = Points;
+  return ADF4351_ERROR_NONE;
+}
+
+#ifndef ARDUINO
+int ADF4351::LoadCalibration(const char *FileName, ADF4351_CalibrationPoint *Calibration, uint16_t MaximumCalibrationPoints, uint16_t *CalibrationPoints) {
+  *CalibrationPoints = 0;
+  FILE *CalibrationFile = fopen(FileName, "rb");
+  if (CalibrationFile == NULL) {
+    return ADF4351_ERROR_CALIBRATION_TABLE;
+  }
+  uint8_t data[ADF4351_CALIBRATION_HEADER_SIZE]; // header and point are the same size
+  uint16_t Points = 0;
+  if (fread(data, 1, ADF4351_CALIBRATION_HEADER_SIZE, CalibrationFile) == ADF4351_CALIBRATION_HEADER_SIZE) {
+    Points = DecodeCalibrationHeader(data, MaximumCalibrationPoints);
+  }
+  int ErrorCode = ADF4351_ERROR_NONE;
+  if (Points == 0) {
+    ErrorCode = ADF4351_ERROR_CALIBRATION_TABLE;
+  }
+  for (uint16_t Point = 0; Point < Points; Point++) {
+    if (fread(data, 1, ADF4351_CALIBRATION_POINT_SIZE, CalibrationFile) != ADF4351_CALIBRATION_POINT_SIZE || DecodeCalibrationPoint(data, Calibration, Point) == false) {
+      ErrorCode = ADF4351_ERROR_CALIBRATION_TABLE;
+      break;
+    }
+  }
+  fclose(CalibrationFile);
+  if (ErrorCode == ADF4351_ERROR_NONE) {
+    *CalibrationPoints = Points;
+  }
+  return ErrorCode;
+}
+#endif
+
+uint16_t ADF4351::DecodeCalibrationHeader(const uint8_t *data, uint16_t MaximumCalibrationPoints) {
+  if (data[0] != 'A' || data[1] != '3' || data[2] != '5' || data[3] != '1') {
+    return 0;
+  }
+  uint16_t Points = (data[4] | (data[5] << 8));
+  if (Points > MaximumCalibrationPoints) {
+    return 0;
+  }
+  return Points;
+}
+
+bool ADF4351::DecodeCalibrationPoint(const uint8_t *data, ADF4351_CalibrationPoint *Calibration, uint16_t Point) {
+  Calibration[Point].Frequency_kHz = ((uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+  Calibration[Point].PowerLevel = data[4];
+  Calibration[Point].AuxPowerLevel = data[5];
+  if (Calibration[Point].PowerLevel > 4 || Calibration[Point].AuxPowerLevel > 4) {
+    return false;
+  }
+  if (Point > 0 && Calibration[Point].Frequency_kHz <= Calibration[(Point - 1)].Frequency_kHz) { // must be in ascending order of frequency
+    return false;
+  }
+  return true;
+}
+
+void ADF4351::SortSweep(uint32_t *regs, uint16_t Points, uint16_t *Order, bool ByRegisters) {
+  for (uint16_t Point = 1; Point < Points; Point++) { // insertion sort - no additional memory is required for the register table
+    uint16_t Position = Point;
+    while (Position > 0) {
+      const uint32_t *Previous = &regs[((Position - 1) * ADF4351_RegsToWrite)];
+      const uint32_t *Current = &regs[(Position * ADF4351_RegsToWrite)];
+      bool Swap;
+      if (ByRegisters == true) {
+        uint32_t PreviousGroup = ((BitFieldManipulation.ReadBF_dword(27, 1, Previous[0x01]) << 3) | BitFieldManipulation.ReadBF_dword(20, 3, Previous[0x04]));
+        uint32_t CurrentGroup = ((BitFieldManipulation.ReadBF_dword(27, 1, Current[0x01]) << 3) | BitFieldManipulation.ReadBF_dword(20, 3, Current[0x04]));
+        Swap = (CurrentGroup < PreviousGroup);
+        if (CurrentGroup == PreviousGroup) {
+          for (uint8_t i = 0; i < ADF4351_RegsToWrite; i++) { // R0 then R1-R4
+            if (Current[i] != Previous[i]) {
+              Swap = (Current[i] < Previous[i]);
+              break;
+            }
+          }
+        }
+      }
+      else {
+        Swap = (Order[Position] < Order[(Position - 1)]);
+      }
+      if (Swap == false) {
+        break;
+      }
+      SwapSweepPoints(regs, Order, Position, (Position - 1));
+      Position--;
+    }
+  }
+}
+
+void ADF4351::SwapSweepPoints(uint32_t *regs, uint16_t *Order, uint16_t PointA, uint16_t PointB) {
+  if (PointA == PointB) {
+    return;
+  }
+  for (uint8_t i = 0; i < ADF4351_RegsToWrite; i++) {
+    uint32_t temp = regs[((PointA * ADF4351_RegsToWrite) + i)];
+    regs[((PointA * ADF4351_RegsToWrite) + i)] = regs[((PointB * ADF4351_RegsToWrite) + i)];
+    regs[((PointB * ADF4351_RegsToWrite) + i)] = temp;
+  }
+  uint16_t temp = Order[PointA];
+  Order[PointA] = Order[PointB];
+  Order[PointB] = temp;
+}
+
 uint16_t ADF4351::ReadR() {
   return BitFieldManipulation.ReadBF_dword(14, 10, ADF4351_R[0x02]);
 }
@@ -132,44 +414,52 @@ double ADF4351::ReadPFDfreq() {
 
 void ADF4351::ReadCurrentFrequency(char *freq)
 {
-  BigNumber::begin(12);
-  char tmpstr[12];
-  ultoa(ADF4351_reffreq, tmpstr, 10);
-  BigNumber BN_ref = BigNumber(tmpstr);
+  uint64_t FrequencyNumerator = ADF4351_reffreq;
+  uint64_t FrequencyDenominator = ReadR();
   if (ReadRDIV2() != 0 && ReadRefDoubler() == 0) {
-    BN_ref /= BigNumber(2);
+    FrequencyDenominator *= 2;
   }
   else if (ReadRDIV2() == 0 && ReadRefDoubler() != 0) {
-    BN_ref *= BigNumber(2);
-  }
-  BN_ref /= BigNumber(ReadR());
-  BigNumber BN_freq = BN_ref;
-  BN_freq *= BigNumber(ReadInt());
-  BN_ref *= BigNumber(ReadFraction());
-  BN_ref /= BigNumber(ReadMod());
-  BN_freq += BN_ref;
-  BN_freq /= BigNumber(ReadOutDivider());
-  BigNumber BN_rounding = BigNumber("0.5");
+    FrequencyNumerator *= 2;
+  }
+  // frequency is (reference * ((INT * MOD) + FRAC)) / (R * MOD * output divider) - maximum is 500 MHz * ((65535 * 4095) + 4095) which will fit in 64 bits
+  FrequencyNumerator *= (((uint64_t)ReadInt() * ReadMod()) + ReadFraction());
+  FrequencyDenominator *= ((uint32_t)ReadMod() * ReadOutDivider());
+  if (FrequencyDenominator == 0) { // avoid division by zero
+    FrequencyNumerator = 0;
+    FrequencyDenominator = 1;
+  }
+  uint64_t FrequencyInteger = (FrequencyNumerator / FrequencyDenominator);
+  uint64_t FrequencyDecimal = (FrequencyNumerator % FrequencyDenominator);
+  uint32_t DecimalScale = 1;
   for (int i = 0; i < ADF4351_DECIMAL_PLACES; i++) {
-    BN_rounding /= BigNumber(10);
-  }
-  BN_freq += BN_rounding;
-  char* temp = BN_freq.toString();
-  BigNumber::finish();
-  uint8_t DecimalPlaceToStart;
-  for (int i = 0; i < (ADF4351_DIGITS + 1); i++){
-    freq[i] = temp[i];
-    if (temp[i] == '.') {
-      DecimalPlaceToStart = i;
-      DecimalPlaceToStart++;
-      break;
-    }
+    DecimalScale *= 10;
+  }
+  FrequencyDecimal = (((2 * FrequencyDecimal * DecimalScale) + FrequencyDenominator) / (2 * FrequencyDenominator)); // rounded to the last decimal place
+  if (FrequencyDecimal >= DecimalScale) {
+    FrequencyDecimal -= DecimalScale;
+    FrequencyInteger++;
+  }
+  char temp[ADF4351_DIGITS];
+  uint8_t Digits = 0;
+  do { // digits are in reverse order
+    temp[Digits] = ('0' + (FrequencyInteger % 10));
+    FrequencyInteger /= 10;
+    Digits++;
+  } while (FrequencyInteger != 0 && Digits < ADF4351_DIGITS);
+  uint8_t DecimalPlaceToStart = 0;
+  while (Digits > 0) {
+    Digits--;
+    freq[DecimalPlaceToStart] = temp[Digits];
+    DecimalPlaceToStart++;
   }
-  for (int i = DecimalPlaceToStart; i < (DecimalPlaceToStart + ADF4351_DECIMAL_PLACES); i++) {
-    freq[i] = temp[i];
+  freq[DecimalPlaceToStart] = '.';
+  DecimalPlaceToStart++;
+  for (int i = (DecimalPlaceToStart + ADF4351_DECIMAL_PLACES - 1); i >= DecimalPlaceToStart; i--) {
+    freq[i] = ('0' + (FrequencyDecimal % 10));
+    FrequencyDecimal /= 10;
   }
   freq[(DecimalPlaceToStart + ADF4351_DECIMAL_PLACES)] = 0x00;
-  free(temp);
 }
 
 void ADF4351::init(uint8_t SSpin, uint8_t LockPinNumber, bool Lock_Pin_Used, uint8_t CEpinNumber, bool CE_Pin_Used)
@@ -177,15 +467,130 @@ void ADF4351::init(uint8_t SSpin, uint8_t LockPinNumber, bool Lock_Pin_Used, uin
   ADF4351_PIN_SS = SSpin;
   pinMode(ADF4351_PIN_SS, OUTPUT) ;
   digitalWrite(ADF4351_PIN_SS, HIGH) ;
+  ADF4351_PIN_CE = CEpinNumber;
+  ADF4351_CE_Used = CE_Pin_Used;
   if (CE_Pin_Used == true) {
     pinMode(CEpinNumber, OUTPUT) ;
   }
+  ADF4351_PIN_LOCK = LockPinNumber;
+  ADF4351_Lock_Used = Lock_Pin_Used;
   if (Lock_Pin_Used == true) {
     pinMode(LockPinNumber, INPUT_PULLUP) ;
   }
   SPI.begin();
 }
 
+void ADF4351::standby() {
+  if (ADF4351_Standby != ADF4351_STANDBY_NONE) {
+    return;
+  }
+  if (ADF4351_CE_Used == true) { // registers are retained while CE is LOW
+    digitalWrite(ADF4351_PIN_CE, LOW);
+    ADF4351_Standby = ADF4351_STANDBY_CE;
+  }
+  else {
+    ADF4351_R[0x02] = BitFieldManipulation.WriteBF_dword(5, 1, ADF4351_R[0x02], 1);
+    WriteRegister(0x02);
+    ADF4351_Standby = ADF4351_STANDBY_POWER_DOWN;
+  }
+}
+
+int ADF4351::resume(bool WaitForLock, uint32_t LockTimeout) {
+  uint32_t WakeTimeStart = micros();
+  bool WasInStandby = (ADF4351_Standby != ADF4351_STANDBY_NONE);
+  if (ADF4351_Standby == ADF4351_STANDBY_CE) {
+    digitalWrite(ADF4351_PIN_CE, HIGH);
+  }
+  else if (ADF4351_Standby == ADF4351_STANDBY_POWER_DOWN) {
+    ADF4351_R[0x02] = BitFieldManipulation.WriteBF_dword(5, 1, ADF4351_R[0x02], 0);
+    WriteRegister(0x02);
+  }
+  if (WasInStandby == true) {
+    WriteRegister(0x00); // ref ADF4351 Datasheet: R0 is written last to begin VCO band selection - remaining registers are unchanged
+    ADF4351_Standby = ADF4351_STANDBY_NONE;
+  }
+  if (WaitForLock == false) {
+    return ADF4351_ERROR_NONE;
+  }
+  if (ADF4351_Lock_Used == false) { // powered up regardless
+    return ADF4351_ERROR_LOCK_PIN_NOT_USED;
+  }
+  if (WasInStandby == false) { // nothing was written so the last wake to lock time is kept
+    return ADF4351_ERROR_NONE;
+  }
+  return WaitForLockDetect(WakeTimeStart, LockTimeout, true, &ADF4351_WakeToLockTime);
+}
+
+int ADF4351::WaitForLockDetect(uint32_t TimeStart, uint32_t LockTimeout, bool BandSelection, uint32_t *LockTime) {
+  if (ADF4351_Lock_Used == false) {
+    return ADF4351_ERROR_LOCK_PIN_NOT_USED;
+  }
+  int ErrorCode = ADF4351_ERROR_LOCK_TIMEOUT;
+  uint32_t BandSelectTime = 0;
+  if (BandSelection == true) { // lock detect may still be HIGH from before R0 was written
+    BandSelectTime = ReadBandSelectTime();
+  }
+  bool LockDetectValid = false;
+  SPI.end(); // lock pin may be shared with MISO
+  while (true) {
+    uint32_t ElapsedTime;
+    if (SampleLockDetect(TimeStart, BandSelectTime, &LockDetectValid, &ElapsedTime) == true) {
+      *LockTime = ElapsedTime;
+      ErrorCode = ADF4351_ERROR_NONE;
+      break;
+    }
+    if (ElapsedTime > LockTimeout) {
+      *LockTime = ElapsedTime;
+      break;
+    }
+  }
+  SPI.begin();
+  return ErrorCode;
+}
+
+bool ADF4351::PollLockDetect(uint32_t TimeStart, uint32_t BandSelectTime, bool *LockDetectValid, uint32_t *LockTime) {
+  if (ADF4351_Lock_Used == false) {
+    return false;
+  }
+  uint32_t ElapsedTime;
+  SPI.end(); // lock pin may be shared with MISO
+  bool Locked = SampleLockDetect(TimeStart, BandSelectTime, LockDetectValid, &ElapsedTime);
+  SPI.begin();
+  if (Locked == true) {
+    *LockTime = ElapsedTime;
+  }
+  return Locked;
+}
+
+bool ADF4351::SampleLockDetect(uint32_t TimeStart, uint32_t BandSelectTime, bool *LockDetectValid, uint32_t *ElapsedTime) {
+  *ElapsedTime = micros();
+  *ElapsedTime -= TimeStart;
+  if (digitalRead(ADF4351_PIN_LOCK) == HIGH) {
+    return (*LockDetectValid == true || *ElapsedTime >= BandSelectTime); // a HIGH before band selection has finished may be from the previous frequency
+  }
+  *LockDetectValid = true;
+  return false;
+}
+
+uint32_t ADF4351::ReadBandSelectTime() {
+  uint32_t PFD_Numerator;
+  uint32_t PFD_Denominator;
+  ReadPFDfraction(&PFD_Numerator, &PFD_Denominator);
+  uint64_t BandSelectTime = (ADF4351_BAND_SELECT_CYCLES * BitFieldManipulation.ReadBF_dword(12, 8, ADF4351_R[0x04])); // band select clock divider
+  BandSelectTime *= (1000000ULL * PFD_Denominator);
+  BandSelectTime += (PFD_Numerator - 1); // rounded up
+  BandSelectTime /= PFD_Numerator;
+  return BandSelectTime;
+}
+
+uint8_t ADF4351::ReadStandby() {
+  return ADF4351_Standby;
+}
+
+uint32_t ADF4351::ReadWakeToLockTime() {
+  return ADF4351_WakeToLockTime;
+}
+
 int ADF4351::SetStepFreq(uint32_t value) {
   if (value > ReadPFDfreq()) {
     return ADF4351_ERROR_STEP_FREQUENCY_EXCEEDS_PFD;
@@ -200,6 +605,23 @@ int ADF4351::SetStepFreq(uint32_t value) {
 }
 
 int ADF4351::setf(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, bool PrecisionFrequency, uint32_t MaximumFrequencyError, uint32_t CalculationTimeout) {
+  if (PrecisionFrequency == true) { // run the incremental precision calculation to completion in one call
+    uint32_t CalculationTimeStart = millis();
+    int ErrorCode = setfPrecisionStart(freq, PowerLevel, AuxPowerLevel, AuxFrequencyDivider, MaximumFrequencyError);
+    if (ErrorCode != ADF4351_ERROR_NONE) {
+      return ErrorCode;
+    }
+    ErrorCode = PrecisionStep(4094, CalculationTimeStart, CalculationTimeout); // covers the entire MOD range of 2 to 4095
+    if (ErrorCode == ADF4351_ERROR_PRECISION_FREQUENCY_CALCULATION_TIMEOUT) {
+      ADF4351_Precision.Started = false;
+      return ErrorCode;
+    }
+    return setfPrecisionCommit();
+  }
+  return CalculateFrequency(freq, PowerLevel, AuxPowerLevel, AuxFrequencyDivider, true);
+}
+
+int ADF4351::CalculateFrequency(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, bool WriteToDevice) {
   ADF4351_FrequencyError = 0;
   //  calculate settings from freq
   if (PowerLevel < 0 || PowerLevel > 4) return ADF4351_ERROR_POWER_LEVEL;
@@ -209,201 +631,287 @@ int ADF4351::setf(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t
 
   uint32_t ReferenceFrequency = ADF4351_reffreq;
   ReferenceFrequency /= ReadR();
-  if (PrecisionFrequency == false && ADF4351_ChanStep > 1 && (ReferenceFrequency % ADF4351_ChanStep) != 0) {
+  if (ADF4351_ChanStep > 1 && (ReferenceFrequency % ADF4351_ChanStep) != 0) {
     return ADF4351_ERROR_PFD_AND_STEP_FREQUENCY_HAS_REMAINDER;
   }
 
-  BigNumber::begin(12); // for a maximum 90 MHz PFD and a 64 RF divider with frequency steps no smaller than 1 Hz, will fit the maximum of 5.76 * (10 ^ 9) for the MOD and FRAC before GCD calculation
-
-  if (BigNumber(freq) > BigNumber("4400000000") || BigNumber(freq) < BigNumber("34375000")) {
-    BigNumber::finish();
+  uint64_t Frequency;
+  if (ParseFrequency(freq, &Frequency) == false) {
     return ADF4351_ERROR_RF_FREQUENCY;
   }
 
-  uint8_t FrequencyPointer = 0;
-  while (true) { // null out any decimal places below 1 Hz increments to avoid GCD calculation input overflow
-    if (freq[FrequencyPointer] == '.') { // change the decimal point to a null terminator
-      freq[FrequencyPointer] = 0x00;
+  if (ADF4351_ChanStep > 1 && (Frequency % ADF4351_ChanStep) != 0) {
+    return ADF4351_ERROR_RF_FREQUENCY_AND_STEP_FREQUENCY_HAS_REMAINDER;
+  }
+
+  uint8_t ADF4351_RfDivSel = CalculateRfDivSel(Frequency);
+  uint8_t ADF4351_outdiv = (1 << ADF4351_RfDivSel);
+  uint8_t ADF4351_Prescaler = 0;
+  uint32_t ADF4351_N_Int;
+  uint32_t ADF4351_Mod;
+  uint32_t ADF4351_Frac;
+
+  // PFD = PFD_Numerator / PFD_Denominator so that all of the following calculations are exact with 64 bit integers - no heap is used
+  uint32_t PFD_Numerator;
+  uint32_t PFD_Denominator;
+  ReadPFDfraction(&PFD_Numerator, &PFD_Denominator);
+
+  if (Frequency > 3600000000ULL) {
+    ADF4351_Prescaler = 1;
+  }
+
+  uint64_t VCO_Scaled = (Frequency * ADF4351_outdiv * PFD_Denominator); // (RF * output divider) / PFD = VCO_Scaled / PFD_Numerator
+  ADF4351_N_Int = (VCO_Scaled / PFD_Numerator);
+  uint64_t N_Remainder = (VCO_Scaled % PFD_Numerator); // fraction of N is N_Remainder / PFD_Numerator
+  // MOD = PFD / step and FRAC = (fraction of N * MOD) rounded - maximum for each is 90 * (10 ^ 6) for a 90 MHz PFD with 1 Hz steps
+  uint64_t StepScaled = ((uint64_t)PFD_Denominator * ADF4351_ChanStep);
+  uint32_t GCD_ADF4351_Mod2 = (PFD_Numerator / StepScaled);
+  uint32_t GCD_ADF4351_Frac2 = (((2 * N_Remainder * ADF4351_outdiv) + StepScaled) / (2 * StepScaled * ADF4351_outdiv));
+
+  // calculate the GCD - Mod2/Frac2 values are temporary
+  uint32_t GCD_t;
+  uint32_t GCD_a = GCD_ADF4351_Mod2;
+  uint32_t GCD_b = GCD_ADF4351_Frac2;
+  while (true) {
+    if (GCD_a == 0) {
+      GCD_t = GCD_b;
       break;
     }
-    if (freq[FrequencyPointer] == 0x00) { // null terminator reached
+    if (GCD_b == 0) {
+      GCD_t = GCD_a;
       break;
     }
-    FrequencyPointer++;
+    if (GCD_a == GCD_b) {
+      GCD_t = GCD_a;
+      break;
+    }
+    if (GCD_a > GCD_b) {
+      GCD_a -= GCD_b;
+    }
+    else {
+      GCD_b -= GCD_a;
+    }
   }
+  GCD_ADF4351_Mod2 /= GCD_t;
+  GCD_ADF4351_Frac2 /= GCD_t;
+  if (GCD_ADF4351_Mod2 > 4095) { // outside valid range
+    while (true) {
+      GCD_ADF4351_Mod2 /= 2;
+      GCD_ADF4351_Frac2 /= 2;
+      if (GCD_ADF4351_Mod2 <= 4095) { // now within valid range
+        if (GCD_ADF4351_Frac2 == GCD_ADF4351_Mod2) { // FRAC must be less than MOD
+          GCD_ADF4351_Frac2--;
+        }
+        break;
+      }
+    }
+  }
+  // set the final FRAC/MOD values
+  ADF4351_Frac = GCD_ADF4351_Frac2;
+  ADF4351_Mod = GCD_ADF4351_Mod2;
+
+  return WriteFrequencyRegs(Frequency, ADF4351_N_Int, ADF4351_Mod, ADF4351_Frac, ADF4351_RfDivSel, ADF4351_Prescaler, PowerLevel, AuxPowerLevel, AuxFrequencyDivider, false, 0, WriteToDevice);
+}
 
-  char tmpstr[12]; // will fit a long including sign and terminator
+int ADF4351::setfPrecisionStart(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, uint32_t MaximumFrequencyError) {
+  ADF4351_Precision.Started = false;
+  ADF4351_FrequencyError = 0;
+  if (PowerLevel < 0 || PowerLevel > 4) return ADF4351_ERROR_POWER_LEVEL;
+  if (AuxPowerLevel < 0 || AuxPowerLevel > 4) return ADF4351_ERROR_AUX_POWER_LEVEL;
+  if (AuxFrequencyDivider != ADF4351_AUX_DIVIDED && AuxFrequencyDivider != ADF4351_AUX_FUNDAMENTAL) return ADF4351_ERROR_AUX_FREQ_DIVIDER;
+  if (ReadPFDfreq() == 0) return ADF4351_ERROR_ZERO_PFD_FREQUENCY;
 
-  if (PrecisionFrequency == false && ADF4351_ChanStep > 1) {
-    ultoa(ADF4351_ChanStep, tmpstr, 10);
-    BigNumber BN_freq = BigNumber(freq);
-    // BigNumber has issues with modulus calculation which always results in 0
-    BN_freq /= BigNumber(tmpstr);
-    uint32_t ChanSteps = (uint32_t)((uint32_t) BN_freq); // round off the decimal - overflow is not an issue for the ADF4351 frequency range
-    ultoa(ChanSteps, tmpstr, 10);
-    BN_freq -= BigNumber(tmpstr);
-    if (BN_freq != BigNumber(0)) {
-      BigNumber::finish();
-      return ADF4351_ERROR_RF_FREQUENCY_AND_STEP_FREQUENCY_HAS_REMAINDER;
-    }
+  if (ParseFrequency(freq, &ADF4351_Precision.Frequency) == false) {
+    return ADF4351_ERROR_RF_FREQUENCY;
   }
 
-  BigNumber BN_localosc_ratio = BigNumber("2200000000") / BigNumber(freq);
-  uint8_t localosc_ratio = (uint32_t)((uint32_t) BN_localosc_ratio);
-  uint8_t ADF4351_outdiv = 1;
-  uint8_t ADF4351_RfDivSel = 0;
-  uint8_t ADF4351_Prescaler = 0;
-  uint32_t ADF4351_N_Int;
-  uint32_t ADF4351_Mod = 2;
-  uint32_t ADF4351_Frac = 0;
-
-  ultoa(ADF4351_reffreq, tmpstr, 10);
-  word CurrentR = ReadR();
-  uint8_t RDIV2 = ReadRDIV2();
-  uint8_t RefDoubler = ReadRefDoubler();
-  BigNumber BN_ADF4351_PFDFreq = (BigNumber(tmpstr) * (BigNumber(1) * BigNumber((1 + RefDoubler))) * (BigNumber(1) / BigNumber((1 + RDIV2)))) / BigNumber(CurrentR);
-  uint32_t PFDFreq = (uint32_t)((uint32_t) BN_ADF4351_PFDFreq); // used for checking maximum PFD limit under Fractional Mode
-
-  // select the output divider
-  if (BigNumber(freq) > BigNumber("34375000")) {
-    while (ADF4351_outdiv <= localosc_ratio && ADF4351_outdiv <= 64) {
-      ADF4351_outdiv *= 2;
-      ADF4351_RfDivSel++;
+  ADF4351_Precision.RfDivSel = CalculateRfDivSel(ADF4351_Precision.Frequency);
+  uint8_t ADF4351_outdiv = (1 << ADF4351_Precision.RfDivSel);
+  ADF4351_Precision.Prescaler = 0;
+  if (ADF4351_Precision.Frequency > 3600000000ULL) {
+    ADF4351_Precision.Prescaler = 1;
+  }
+  ADF4351_Precision.Mod = 2;
+  ADF4351_Precision.Frac = 0;
+  ADF4351_Precision.NextMod = 0;
+
+  ReadPFDfraction(&ADF4351_Precision.PFD_Numerator, &ADF4351_Precision.PFD_Denominator); // kept for the rest of the calculation
+  uint32_t PFD_Numerator = ADF4351_Precision.PFD_Numerator;
+  uint32_t PFD_Denominator = ADF4351_Precision.PFD_Denominator;
+  uint64_t VCO_Scaled = (ADF4351_Precision.Frequency * ADF4351_outdiv * PFD_Denominator); // for 4007.5 MHz RF/10 MHz PFD, N is 400.75
+  ADF4351_Precision.N_Int = (VCO_Scaled / PFD_Numerator); // round off the decimal
+  // frequency is 4007.5 MHz, PFD is 10 MHz and output divider is 2 - integer is 4000 MHz, remainder is 7.5 MHz
+  // remainder in Hz is Remainder / (PFD_Denominator * output divider) which is always less than PFD / output divider
+  ADF4351_Precision.Remainder = (VCO_Scaled % PFD_Numerator);
+  // deal with N having remainder greater than (4094 / 4095) and a frequency within ((PFD - (PFD * (1 / 4095)) / output divider)
+  if (((PFD_Numerator - ADF4351_Precision.Remainder) * 100000000ULL) > (24421ULL * PFD_Numerator)) {
+    ADF4351_Precision.BestError = (ADF4351_Precision.Remainder / ((uint32_t)PFD_Denominator * ADF4351_outdiv)); // initial value should the MOD match loop fail to result in FRAC < MOD
+    if (ADF4351_Precision.BestError > MaximumFrequencyError) { // use fractional division if out of tolerance
+      ADF4351_Precision.NextMod = 2;
     }
   }
   else {
-    ADF4351_outdiv = 64;
-    ADF4351_RfDivSel = 6;
+    ADF4351_Precision.N_Int++;
+    ADF4351_Precision.BestError = ((PFD_Numerator - ADF4351_Precision.Remainder) / ((uint32_t)PFD_Denominator * ADF4351_outdiv));
   }
 
-  if (BigNumber(freq) > BigNumber("3600000000")) {
-    ADF4351_Prescaler = 1;
+  ADF4351_Precision.MaximumFrequencyError = MaximumFrequencyError;
+  ADF4351_Precision.PowerLevel = PowerLevel;
+  ADF4351_Precision.AuxPowerLevel = AuxPowerLevel;
+  ADF4351_Precision.AuxFrequencyDivider = AuxFrequencyDivider;
+  ADF4351_Precision.Started = true;
+  return ADF4351_ERROR_NONE;
+}
+
+int ADF4351::setfPrecisionStep(uint16_t ModCandidates) {
+  return PrecisionStep(ModCandidates, 0, 0);
+}
+
+int ADF4351::PrecisionStep(uint16_t ModCandidates, uint32_t CalculationTimeStart, uint32_t CalculationTimeout) {
+  if (ADF4351_Precision.Started == false) {
+    return ADF4351_ERROR_PRECISION_CALCULATION_NOT_STARTED;
+  }
+  if (ADF4351_Precision.NextMod == 0) { // search has finished
+    return ADF4351_ERROR_NONE;
   }
 
-  bool CalculationTookTooLong = false;
-  BigNumber BN_ADF4351_N_Int = (BigNumber(freq) / BN_ADF4351_PFDFreq) * BigNumber(ADF4351_outdiv); // for 4007.5 MHz RF/10 MHz PFD, result is 400.75;
-  ADF4351_N_Int = (uint32_t)((uint32_t) BN_ADF4351_N_Int); // round off the decimal
-  ultoa(ADF4351_N_Int, tmpstr, 10);
-  BigNumber BN_FrequencyRemainder;
-  if (PrecisionFrequency == true) { // frequency is 4007.5 MHz, PFD is 10 MHz and output divider is 2
-    uint32_t CalculationTimeStart = millis();
-    BN_FrequencyRemainder = ((BN_ADF4351_PFDFreq * BigNumber(tmpstr)) / BigNumber(ADF4351_outdiv)) - BigNumber(freq); // integer is 4000 MHz, remainder is -7.5 MHz and will be converterd to a positive
-    if (BN_FrequencyRemainder < BigNumber(0)) {
-      BN_FrequencyRemainder *= BigNumber("-1"); // convert to a postivie
-    }
-    BigNumber BN_ADF4351_N_Int_Overflow = (BN_ADF4351_N_Int + BigNumber("0.00024421")); // deal with N having remainder greater than (4094 / 4095) and a frequency within ((PFD - (PFD * (1 / 4095)) / output divider)
-    uint32_t ADF4351_N_Int_Overflow = (uint32_t)((uint32_t) BN_ADF4351_N_Int_Overflow);
-    if (ADF4351_N_Int_Overflow == ADF4351_N_Int) { // deal with N having remainder greater than (4094 / 4095) and a frequency within ((PFD - (PFD * (1 / 4095)) / output divider)
-      ADF4351_FrequencyError = (int32_t)((int32_t) BN_FrequencyRemainder); // initial value should the MOD match loop fail to result in FRAC < MOD
-      if (ADF4351_FrequencyError > MaximumFrequencyError) { // use fractional division if out of tolerance
-        uint32_t FreqeucnyError = ADF4351_FrequencyError;
-        uint32_t PreviousFrequencyError = ADF4351_FrequencyError;
-        for (word ModToMatch = 2; ModToMatch <= 4095; ModToMatch++) {
-          if (CalculationTimeout > 0) {
-            uint32_t CalculationTime = millis();
-            CalculationTime -= CalculationTimeStart;
-            if (CalculationTime > CalculationTimeout) {
-              CalculationTookTooLong = true;
-              break;
-            }
-          }
-          BigNumber BN_ModFrequencyStep = BN_ADF4351_PFDFreq / BigNumber(ModToMatch) / BigNumber(ADF4351_outdiv); // For 4007.5 MHz RF/10 MHz PFD, should be 4
-          BigNumber BN_TempFrac = (BN_FrequencyRemainder / BN_ModFrequencyStep) + BigNumber("0.5"); // result should be 3 to correspond with above line
-          uint32_t TempFrac = (uint32_t)((uint32_t) BN_TempFrac);
-          if (TempFrac <= ModToMatch) { // FRAC must be < MOD
-            if (TempFrac == ModToMatch) { // FRAC must be < MOD
-              TempFrac--;
-            }
-            ultoa(TempFrac, tmpstr, 10);
-            BigNumber BN_FrequencyError = (BN_FrequencyRemainder - (BigNumber(tmpstr) * BN_ModFrequencyStep));
-            if (BN_FrequencyError < BigNumber(0)) {
-              BN_FrequencyError *= BigNumber("-1"); // convert to a positive
-            }
-            ADF4351_FrequencyError = (int32_t)((int32_t) BN_FrequencyError);
-            if (ADF4351_FrequencyError < PreviousFrequencyError) {
-              PreviousFrequencyError = ADF4351_FrequencyError;
-              ADF4351_Mod = ModToMatch; // result should be 4 for 4007.5 MHz/10 MHz PFD
-              ADF4351_Frac = TempFrac; // result should be 3 to correspond with above line
-            }
-            if (ADF4351_FrequencyError <= MaximumFrequencyError) { // tolerance has been obtained - for 4007.5 MHz, MOD = 4, FRAC = 3; error = 0
-              break;
-            }
-          }
-        }
+  uint32_t PFD_Numerator = ADF4351_Precision.PFD_Numerator;
+  uint32_t PFD_Denominator = ADF4351_Precision.PFD_Denominator;
+  uint32_t RemainderDenominator = ((uint32_t)PFD_Denominator * (1 << ADF4351_Precision.RfDivSel));
+
+  int ErrorCode = ADF4351_WARNING_PRECISION_CALCULATION_INCOMPLETE;
+  for (uint16_t Candidate = 0; Candidate < ModCandidates; Candidate++) {
+    if (CalculationTimeout > 0) {
+      uint32_t CalculationTime = millis();
+      CalculationTime -= CalculationTimeStart;
+      if (CalculationTime > CalculationTimeout) {
+        ErrorCode = ADF4351_ERROR_PRECISION_FREQUENCY_CALCULATION_TIMEOUT;
+        break;
       }
     }
-    else {
-      ADF4351_N_Int++;
-    }
-    ultoa(ADF4351_N_Int, tmpstr, 10);
-  }
-  else {
-    BN_ADF4351_N_Int = (((BigNumber(freq) * BigNumber(ADF4351_outdiv))) / BN_ADF4351_PFDFreq);
-    ADF4351_N_Int = (uint32_t)((uint32_t) BN_ADF4351_N_Int);
-    ultoa(ADF4351_ChanStep, tmpstr, 10);
-    BigNumber BN_ADF4351_Mod = (BN_ADF4351_PFDFreq / (BigNumber(tmpstr) / BigNumber(ADF4351_outdiv)));
-    ultoa(ADF4351_N_Int, tmpstr, 10);
-    BigNumber BN_ADF4351_Frac = (((BN_ADF4351_N_Int - BigNumber(tmpstr)) * BN_ADF4351_Mod) + BigNumber("0.5"));
-    // for a maximum 90 MHz PFD and a 64 RF divider with frequency steps no smaller than 1 Hz, maximum results for each is 5.76 * (10 ^ 9) but can be divided by the RF division ratio without error (results will be no larger than 90 * (10 ^ 6))
-    BN_ADF4351_Frac /= BigNumber(ADF4351_outdiv);
-    BN_ADF4351_Mod /= BigNumber(ADF4351_outdiv);
-
-    // calculate the GCD - Mod2/Frac2 values are temporary
-    uint32_t GCD_ADF4351_Mod2 = (uint32_t)((uint32_t) BN_ADF4351_Mod);
-    uint32_t GCD_ADF4351_Frac2 = (uint32_t)((uint32_t) BN_ADF4351_Frac);
-    uint32_t GCD_t;
-    while (true) {
-      if (GCD_ADF4351_Mod2 == 0) {
-        GCD_t = GCD_ADF4351_Frac2;
-        break;
+    word ModToMatch = ADF4351_Precision.NextMod;
+    // frequency step for each FRAC is PFD / MOD / output divider - for 4007.5 MHz RF/10 MHz PFD with a MOD of 4, FRAC is 3 which is the remainder divided by the frequency step rounded
+    uint64_t RemainderScaled = (ADF4351_Precision.Remainder * ModToMatch);
+    uint32_t TempFrac = (((2 * RemainderScaled) + PFD_Numerator) / (2 * (uint64_t)PFD_Numerator));
+    bool ToleranceObtained = false;
+    if (TempFrac <= ModToMatch) { // FRAC must be < MOD
+      if (TempFrac == ModToMatch) { // FRAC must be < MOD
+        TempFrac--;
       }
-      if (GCD_ADF4351_Frac2 == 0) {
-        GCD_t = GCD_ADF4351_Mod2;
-        break;
+      uint64_t FracScaled = ((uint64_t)TempFrac * PFD_Numerator);
+      uint64_t ErrorScaled; // convert to a positive
+      if (RemainderScaled >= FracScaled) {
+        ErrorScaled = (RemainderScaled - FracScaled);
       }
-      if (GCD_ADF4351_Mod2 == GCD_ADF4351_Frac2) {
-        GCD_t = GCD_ADF4351_Mod2;
-        break;
+      else {
+        ErrorScaled = (FracScaled - RemainderScaled);
       }
-      if (GCD_ADF4351_Mod2 > GCD_ADF4351_Frac2) {
-        GCD_ADF4351_Mod2 -= GCD_ADF4351_Frac2;
+      uint32_t FrequencyError = (ErrorScaled / ((uint64_t)RemainderDenominator * ModToMatch));
+      if (FrequencyError < ADF4351_Precision.BestError) {
+        ADF4351_Precision.BestError = FrequencyError;
+        ADF4351_Precision.Mod = ModToMatch; // result should be 4 for 4007.5 MHz/10 MHz PFD
+        ADF4351_Precision.Frac = TempFrac; // result should be 3 to correspond with above line
       }
-      else {
-        GCD_ADF4351_Frac2 -= GCD_ADF4351_Mod2;
+      if (FrequencyError <= ADF4351_Precision.MaximumFrequencyError) { // tolerance has been obtained - for 4007.5 MHz, MOD = 4, FRAC = 3; error = 0
+        ToleranceObtained = true;
       }
     }
-    // restore the original Mod2/Frac2 temporary values before dividing by GCD
-    GCD_ADF4351_Mod2 = (uint32_t)((uint32_t) BN_ADF4351_Mod);
-    GCD_ADF4351_Frac2 = (uint32_t)((uint32_t) BN_ADF4351_Frac);
-    GCD_ADF4351_Mod2 /= GCD_t;
-    GCD_ADF4351_Frac2 /= GCD_t;
-    if (GCD_ADF4351_Mod2 > 4095) { // outside valid range
-      while (true) {
-        GCD_ADF4351_Mod2 /= 2;
-        GCD_ADF4351_Frac2 /= 2;
-        if (GCD_ADF4351_Mod2 <= 4095) { // now within valid range
-          if (GCD_ADF4351_Frac2 == GCD_ADF4351_Mod2) { // FRAC must be less than MOD
-            GCD_ADF4351_Frac2--;
-          }
-          break;
-        }
-      }
+    if (ToleranceObtained == true || ModToMatch >= 4095) {
+      ADF4351_Precision.NextMod = 0;
+      ErrorCode = ADF4351_ERROR_NONE;
+      break;
     }
-    // set the final FRAC/MOD values
-    ADF4351_Frac = GCD_ADF4351_Frac2;
-    ADF4351_Mod = GCD_ADF4351_Mod2;
+    ADF4351_Precision.NextMod++;
   }
+  return ErrorCode;
+}
 
-  if (CalculationTookTooLong == true) {
-    BigNumber::finish();
-    return ADF4351_ERROR_PRECISION_FREQUENCY_CALCULATION_TIMEOUT;
+int ADF4351::setfPrecisionCommit() {
+  if (ADF4351_Precision.Started == false) {
+    return ADF4351_ERROR_PRECISION_CALCULATION_NOT_STARTED;
+  }
+  ADF4351_Precision.Started = false;
+  uint32_t PFD_Numerator;
+  uint32_t PFD_Denominator;
+  ReadPFDfraction(&PFD_Numerator, &PFD_Denominator);
+  if (((uint64_t)PFD_Numerator * ADF4351_Precision.PFD_Denominator) != ((uint64_t)ADF4351_Precision.PFD_Numerator * PFD_Denominator)) { // R2 changed by WriteSweepValues/WriteSweepValuesChanged since setfPrecisionStart
+    return ADF4351_ERROR_PRECISION_CALCULATION_NOT_STARTED;
   }
+  return WriteFrequencyRegs(ADF4351_Precision.Frequency, ADF4351_Precision.N_Int, ADF4351_Precision.Mod, ADF4351_Precision.Frac, ADF4351_Precision.RfDivSel, ADF4351_Precision.Prescaler, ADF4351_Precision.PowerLevel, ADF4351_Precision.AuxPowerLevel, ADF4351_Precision.AuxFrequencyDivider, true, ADF4351_Precision.MaximumFrequencyError, true);
+}
+
+bool ADF4351::setfPrecisionBusy() {
+  return (ADF4351_Precision.Started == true && ADF4351_Precision.NextMod != 0);
+}
+
+void ADF4351::setfPrecisionCancel() {
+  ADF4351_Precision.Started = false;
+}
+
+uint32_t ADF4351::ReadPrecisionFrequencyError() {
+  return ADF4351_Precision.BestError;
+}
+
+void ADF4351::ReadPFDfraction(uint32_t *PFD_Numerator, uint32_t *PFD_Denominator) {
+  *PFD_Numerator = (ADF4351_reffreq * (1 + ReadRefDoubler())); // maximum of 500 MHz
+  *PFD_Denominator = ((1 + ReadRDIV2()) * ReadR()); // maximum of 2046
+}
 
-  // tmpstr is the N value
-  BN_FrequencyRemainder = (((((BN_ADF4351_PFDFreq * BigNumber(tmpstr)) + (BigNumber(ADF4351_Frac) * (BN_ADF4351_PFDFreq / BigNumber(ADF4351_Mod)))) / BigNumber(ADF4351_outdiv))) - BigNumber(freq)) + BigNumber("0.5"); // no issue with divide by 0 regarding MOD (set to 2 by default) and FRAC (set to 0 by default) - maximum is PFD maximum frequency of 90 MHz under integer mode - no issues with signed overflow or underflow
-  ADF4351_FrequencyError = (int32_t)((int32_t) BN_FrequencyRemainder);
+bool ADF4351::ParseFrequency(char *freq, uint64_t *Frequency) {
+  uint64_t value = 0;
+  bool FractionalHz = false;
+  uint8_t FrequencyPointer = 0;
+  while (freq[FrequencyPointer] >= '0' && freq[FrequencyPointer] <= '9') {
+    if (value <= 99999999999ULL) { // any larger is out of range regardless
+      value *= 10;
+      value += (freq[FrequencyPointer] - '0');
+    }
+    FrequencyPointer++;
+  }
+  if (freq[FrequencyPointer] == '.') { // null out any decimal places below 1 Hz increments
+    freq[FrequencyPointer] = 0x00;
+    FrequencyPointer++;
+    while (freq[FrequencyPointer] >= '0' && freq[FrequencyPointer] <= '9') {
+      if (freq[FrequencyPointer] != '0') {
+        FractionalHz = true;
+      }
+      FrequencyPointer++;
+    }
+  }
+  if (value > 4400000000ULL || (value == 4400000000ULL && FractionalHz == true) || value < 34375000ULL) {
+    return false;
+  }
+  *Frequency = value;
+  return true;
+}
+
+uint8_t ADF4351::CalculateRfDivSel(uint64_t Frequency) {
+  uint8_t localosc_ratio = (uint32_t)(2200000000ULL / Frequency);
+  uint8_t ADF4351_outdiv = 1;
+  uint8_t ADF4351_RfDivSel = 0;
+  if (Frequency > 34375000ULL) {
+    while (ADF4351_outdiv <= localosc_ratio && ADF4351_outdiv <= 64) {
+      ADF4351_outdiv *= 2;
+      ADF4351_RfDivSel++;
+    }
+  }
+  else {
+    ADF4351_RfDivSel = 6;
+  }
+  return ADF4351_RfDivSel;
+}
 
-  BigNumber::finish();
+int ADF4351::WriteFrequencyRegs(uint64_t Frequency, uint32_t ADF4351_N_Int, uint32_t ADF4351_Mod, uint32_t ADF4351_Frac, uint8_t ADF4351_RfDivSel, uint8_t ADF4351_Prescaler, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, bool PrecisionFrequency, uint32_t MaximumFrequencyError, bool WriteToDevice) {
+  uint8_t ADF4351_outdiv = (1 << ADF4351_RfDivSel);
+  uint32_t PFD_Numerator;
+  uint32_t PFD_Denominator;
+  ReadPFDfraction(&PFD_Numerator, &PFD_Denominator);
+  uint32_t PFDFreq = (PFD_Numerator / PFD_Denominator); // used for checking maximum PFD limit under Fractional Mode
+  if (ADF4351_Mod != 0) { // frequency error rounded - maximum is 90 MHz PFD * (65535 * 4095) which will fit in 64 bits
+    int64_t ErrorDenominator = ((int64_t)PFD_Denominator * ADF4351_Mod * ADF4351_outdiv);
+    int64_t ErrorNumerator = ((int64_t)PFD_Numerator * (((int64_t)ADF4351_N_Int * ADF4351_Mod) + ADF4351_Frac)) - ((int64_t)Frequency * ErrorDenominator);
+    ADF4351_FrequencyError = (((2 * ErrorNumerator) + ErrorDenominator) / (2 * ErrorDenominator));
+  }
 
   if (ADF4351_Frac == 0) { // correct the MOD to the minimum required value
     ADF4351_Mod = 2;
@@ -485,7 +993,9 @@ int ADF4351::setf(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t
   // (0x04, 11,1,0) vco power down
   ADF4351_R[0x04] = BitFieldManipulation.WriteBF_dword(20, 3, ADF4351_R[0x04], ADF4351_RfDivSel);
   // (0x04, 24,8,0) reserved
-  WriteRegs();
+  if (WriteToDevice == true) {
+    WriteRegs();
+  }
 
   bool NegativeError = false;
   if (ADF4351_FrequencyError < 0) { // convert to a positive for frequency error comparison with a positive value
@@ -521,6 +1031,7 @@ int ADF4351::setrf(uint32_t f, uint16_t r, uint8_t ReferenceDivisionType) {
   if ( newfreq > ADF4351_PFD_MAX || newfreq < ADF4351_PFD_MIN ) return ADF4351_ERROR_PFD_LIMITS;
 
   ADF4351_reffreq = f ;
+  ADF4351_Precision.Started = false; // the PFD of a precision frequency calculation in progress is no longer valid
   ADF4351_R[0x02] = BitFieldManipulation.WriteBF_dword(14, 10, ADF4351_R[0x02], r);
   if (ReferenceDivisionType == ADF4351_REF_DOUBLE) {
     ADF4351_R[0x02] = BitFieldManipulation.WriteBF_dword(24, 2, ADF4351_R[0x02], 0b00000010);
@@ -558,6 +1069,7 @@ void ADF4351::setfDirect(uint16_t R_divider, uint16_t INT_value, uint16_t MOD_va
       RF_DIVIDER_value = 6;
       break;
   }
+  ADF4351_Precision.Started = false; // the PFD of a precision frequency calculation in progress is no longer valid
   ADF4351_R[0x02] = BitFieldManipulation.WriteBF_dword(14, 10, ADF4351_R[0x02], R_divider);
   ADF4351_R[0x00] = BitFieldManipulation.WriteBF_dword(15, 16, ADF4351_R[0x00], INT_value);
   ADF4351_R[0x01] = BitFieldManipulation.WriteBF_dword(3, 12, ADF4351_R[0x01], MOD_value);
@@ -631,4 +1143,84 @@ int ADF4351::setPDpolarity(uint8_t PDpolarity) {
   else {
     return ADF4351_ERROR_POLARITY_INVALID;
   }
-}
\ No newline at end of file
+}
+
+void ADF4351PingPong::init(ADF4351 *SynthesizerA, ADF4351 *SynthesizerB, uint8_t SwitchPin) {
+  ADF4351_Synthesizer[0] = SynthesizerA;
+  ADF4351_Synthesizer[1] = SynthesizerB;
+  ADF4351_PIN_SWITCH = SwitchPin;
+  ADF4351_Active = 0;
+  ADF4351_Prepared = false;
+  pinMode(ADF4351_PIN_SWITCH, OUTPUT);
+  digitalWrite(ADF4351_PIN_SWITCH, LOW); // synthesizer A
+  ClearHopStatistics();
+}
+
+void ADF4351PingPong::prepare(const uint32_t *regs) {
+  ADF4351_Synthesizer[(ADF4351_Active ^ 1)]->WriteSweepValuesChanged(regs);
+  ADF4351_PrepareTime = micros();
+  ADF4351_BandSelectTime = ADF4351_Synthesizer[(ADF4351_Active ^ 1)]->ReadBandSelectTime(); // R0 is always written
+  ADF4351_LockDetectValid = false;
+  ADF4351_Locked = false;
+  ADF4351_Prepared = true;
+}
+
+bool ADF4351PingPong::poll() {
+  if (ADF4351_Prepared == true && ADF4351_Locked == false) {
+    ADF4351_Locked = ADF4351_Synthesizer[(ADF4351_Active ^ 1)]->PollLockDetect(ADF4351_PrepareTime, ADF4351_BandSelectTime, &ADF4351_LockDetectValid, &ADF4351_LockTime);
+  }
+  return ADF4351_Locked;
+}
+
+int ADF4351PingPong::hop(uint32_t LockDeadline, bool SwitchOnTimeout) {
+  if (ADF4351_Prepared == false) {
+    return ADF4351_ERROR_HOP_NOT_PREPARED;
+  }
+  ADF4351 *Idle = ADF4351_Synthesizer[(ADF4351_Active ^ 1)];
+  if (Idle->ADF4351_Lock_Used == false) {
+    return ADF4351_ERROR_LOCK_PIN_NOT_USED;
+  }
+  if (ADF4351_Locked == false) { // not yet seen by poll
+    ADF4351_Locked = (Idle->WaitForLockDetect(ADF4351_PrepareTime, LockDeadline, (ADF4351_LockDetectValid == false), &ADF4351_LockTime) == ADF4351_ERROR_NONE);
+  }
+  int ErrorCode = ADF4351_ERROR_NONE;
+  ADF4351_Statistics.LastLockTime = ADF4351_LockTime;
+  if (ADF4351_Locked == true && ADF4351_LockTime <= LockDeadline) {
+    ADF4351_Statistics.TotalLockTime += ADF4351_LockTime;
+    if (ADF4351_LockTime > ADF4351_Statistics.MaximumLockTime) {
+      ADF4351_Statistics.MaximumLockTime = ADF4351_LockTime;
+    }
+  }
+  else {
+    ErrorCode = ADF4351_ERROR_LOCK_TIMEOUT;
+    ADF4351_Statistics.MissedDeadlines++;
+    if (ADF4351_Locked == false && SwitchOnTimeout == false) { // remain prepared so that hop may be called again
+      return ErrorCode;
+    }
+  }
+  ADF4351_Active ^= 1;
+  digitalWrite(ADF4351_PIN_SWITCH, ADF4351_Active);
+  ADF4351_Prepared = false;
+  ADF4351_Statistics.Hops++;
+  return ErrorCode;
+}
+
+ADF4351 *ADF4351PingPong::ReadActive() {
+  return ADF4351_Synthesizer[ADF4351_Active];
+}
+
+ADF4351 *ADF4351PingPong::ReadIdle() {
+  return ADF4351_Synthesizer[(ADF4351_Active ^ 1)];
+}
+
+void ADF4351PingPong::ReadHopStatistics(ADF4351_HopStatistics *Statistics) {
+  *Statistics = ADF4351_Statistics;
+}
+
+void ADF4351PingPong::ClearHopStatistics() {
+  ADF4351_Statistics.Hops = 0;
+  ADF4351_Statistics.MissedDeadlines = 0;
+  ADF4351_Statistics.LastLockTime = 0;
+  ADF4351_Statistics.MaximumLockTime = 0;
+  ADF4351_Statistics.TotalLockTime = 0;
+}
@@ -10,7 +10,6 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <stdint.h>
-#include <BigNumber.h>
 #include <BitFieldManipulation.h>
 #include <BeyondByte.h>
 
@@ -28,6 +27,9 @@
 #define ADF4351_REF_DOUBLE 2
 #define ADF4351_LOOP_TYPE_INVERTING 0
 #define ADF4351_LOOP_TYPE_NONINVERTING 1
+#define ADF4351_STANDBY_NONE 0
+#define ADF4351_STANDBY_CE 1
+#define ADF4351_STANDBY_POWER_DOWN 2
 
 // common to all of the following subroutines
 #define ADF4351_ERROR_NONE 0
@@ -63,8 +65,47 @@
 // setPDpolarity
 #define ADF4351_ERROR_POLARITY_INVALID 21
 
+// setfPrecisionStep
+#define ADF4351_WARNING_PRECISION_CALCULATION_INCOMPLETE 22
+
+// setfPrecisionStep and setfPrecisionCommit
+#define ADF4351_ERROR_PRECISION_CALCULATION_NOT_STARTED 23
+
+// CompileLeveledSweep, ReadCalibration and LoadCalibration
+#define ADF4351_ERROR_CALIBRATION_TABLE 24
+
+// resume, WaitForLockDetect and ADF4351PingPong::hop
+#define ADF4351_ERROR_LOCK_PIN_NOT_USED 25
+#define ADF4351_ERROR_LOCK_TIMEOUT 26
+
+// ADF4351PingPong::hop
+#define ADF4351_ERROR_HOP_NOT_PREPARED 27
+
 #define ADF4351_RegsToWrite 5UL // for high speed sweep
 
+#define ADF4351_BAND_SELECT_CYCLES 10UL // VCO band selection time in band select clock cycles - lock detect is not valid until this has elapsed or it has gone LOW after R0 is written
+
+// ScheduleSweep/SweepCost - modelled retune cost in units of a single register write
+#define ADF4351_SWEEP_COST_REGISTER 1
+#define ADF4351_SWEEP_COST_DIVIDER_CHANGE 20 // RF divider or prescaler change - VCO band selection and settling over a wider frequency change
+#define ADF4351_SWEEP_COST_BAND_CHANGE 10 // INT change within the same RF divider and prescaler - modelled as a VCO band change
+
+// ReadCalibration/LoadCalibration - "A351" followed by a little endian uint16_t point count then each point as a little endian uint32_t frequency in kHz, power level and auxiliary power level
+#define ADF4351_CALIBRATION_HEADER_SIZE 6
+#define ADF4351_CALIBRATION_POINT_SIZE 6
+
+/*!
+   @brief Output power calibration point for a leveled sweep
+
+   Power levels are as per setf (0 to disable or 1-4) and points must be
+   in ascending order of frequency.
+*/
+struct ADF4351_CalibrationPoint {
+  uint32_t Frequency_kHz;
+  uint8_t PowerLevel;
+  uint8_t AuxPowerLevel;
+};
+
 // ReadCurrentFrequency
 #define ADF4351_DIGITS 10
 #define ADF4351_DECIMAL_PLACES 6
@@ -103,6 +144,10 @@ class ADF4351
        @param order the SPI bit order (see SPI bit order values)
     */
     uint8_t ADF4351_PIN_SS = 10;   ///< Ard Pin for SPI Slave Select
+    uint8_t ADF4351_PIN_CE = 0;    ///< Ard Pin for Chip Enable
+    bool ADF4351_CE_Used = false;
+    uint8_t ADF4351_PIN_LOCK = 0;  ///< Ard Pin for Lock Detect
+    bool ADF4351_Lock_Used = false;
 
     ADF4351();
     void WriteRegs();
@@ -128,10 +173,35 @@ class ADF4351
 
     void WriteSweepValues(const uint32_t *regs);
     void ReadSweepValues(uint32_t *regs);
+    void WriteSweepValuesChanged(const uint32_t *regs); // writes only the registers which have changed
+    int CalculateSweepValues(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, uint32_t *regs); // calculates without writing to the ADF4351
+    uint32_t SweepCost(const uint32_t *regs, uint16_t Points);
+    void ScheduleSweep(uint32_t *regs, uint16_t Points, uint16_t *Order, uint32_t *CostBefore, uint32_t *CostAfter); // reorders the sweep for the lowest retune cost
+    int CompileLeveledSweep(char **freqs, uint16_t Points, const ADF4351_CalibrationPoint *Calibration, uint16_t CalibrationPoints, uint8_t AuxFrequencyDivider, uint32_t *regs); // power levels are interpolated from the calibration table and included in the register sets
+    void InterpolatePowerLevel(uint32_t Frequency_kHz, const ADF4351_CalibrationPoint *Calibration, uint16_t CalibrationPoints, uint8_t *PowerLevel, uint8_t *AuxPowerLevel);
+    int ReadCalibration(const uint8_t *data, uint32_t DataSize, ADF4351_CalibrationPoint *Calibration, uint16_t MaximumCalibrationPoints, uint16_t *CalibrationPoints);
+#ifndef ARDUINO
+    int LoadCalibration(const char *FileName, ADF4351_CalibrationPoint *Calibration, uint16_t MaximumCalibrationPoints, uint16_t *CalibrationPoints); // host build only
+#endif
     void ReadCurrentFrequency(char *freq);
     int setCPcurrent(float Current);
     int setPDpolarity(uint8_t PDpolarity);
 
+    int setfPrecisionStart(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, uint32_t FrequencyTolerance); // begin a precision frequency calculation without writing to the ADF4351
+    int setfPrecisionStep(uint16_t ModCandidates); // try up to ModCandidates MOD values, keeping the best FRAC/MOD found so far
+    int setfPrecisionCommit(); // write the best FRAC/MOD found so far
+    bool setfPrecisionBusy();
+    void setfPrecisionCancel();
+    uint32_t ReadPrecisionFrequencyError();
+
+    void standby(); // power down with CE if used, otherwise with the power down bit (Bit 5 of ADF4351_R[2])
+    int resume(bool WaitForLock, uint32_t LockTimeout); // power up on the same frequency with optional wait for lock detect (timeout in uS)
+    uint8_t ReadStandby();
+    uint32_t ReadWakeToLockTime();
+    int WaitForLockDetect(uint32_t TimeStart, uint32_t LockTimeout, bool BandSelection, uint32_t *LockTime); // LockTimeout and LockTime are in uS from TimeStart as per micros() - BandSelection is true if R0 was written at TimeStart
+    bool PollLockDetect(uint32_t TimeStart, uint32_t BandSelectTime, bool *LockDetectValid, uint32_t *LockTime); // single lock pin read without waiting - returns true on a valid lock detect
+    uint32_t ReadBandSelectTime(); // uS
+
     SPISettings ADF4351_SPI;
 
     int32_t ADF4351_FrequencyError = 0;
@@ -139,7 +209,108 @@ class ADF4351
     uint32_t ADF4351_reffreq = ADF4351_REF_FREQ_DEFAULT;
     uint32_t ADF4351_R[6] {0x00000000, 0x00008011, 0x00006FC2, 0x00E00483, 0x00850004, 0x00580005};
     uint32_t ADF4351_ChanStep = 100000UL;
+    uint8_t ADF4351_Standby = ADF4351_STANDBY_NONE;
+    uint32_t ADF4351_WakeToLockTime = 0; // uS from resume() to lock detect
+
+  private:
+    struct PrecisionState {
+      bool Started = false;
+      uint64_t Frequency; // integer Hz only
+      uint64_t Remainder; // frequency remainder from N in units of 1 / (PFD denominator * output divider) Hz
+      uint32_t PFD_Numerator; // PFD at setfPrecisionStart() - setrf() and setfDirect() end the calculation
+      uint32_t PFD_Denominator;
+      uint16_t NextMod = 0; // 0 when the MOD search has finished
+      uint32_t N_Int;
+      uint32_t Mod;
+      uint32_t Frac;
+      uint32_t BestError;
+      uint32_t MaximumFrequencyError;
+      uint8_t RfDivSel;
+      uint8_t Prescaler;
+      uint8_t PowerLevel;
+      uint8_t AuxPowerLevel;
+      uint8_t AuxFrequencyDivider;
+    };
+    PrecisionState ADF4351_Precision;
+
+    void WriteRegister(uint8_t reg);
+    int CalculateFrequency(char *freq, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, bool WriteToDevice);
+    uint32_t SweepTransitionCost(const uint32_t *FromRegs, const uint32_t *ToRegs);
+    uint8_t InterpolateLevel(uint8_t LowLevel, uint8_t HighLevel, uint32_t Span, uint32_t Offset);
+    uint16_t DecodeCalibrationHeader(const uint8_t *data, uint16_t MaximumCalibrationPoints); // returns 0 if invalid
+    bool DecodeCalibrationPoint(const uint8_t *data, ADF4351_CalibrationPoint *Calibration, uint16_t Point);
+    bool SampleLockDetect(uint32_t TimeStart, uint32_t BandSelectTime, bool *LockDetectValid, uint32_t *ElapsedTime); // SPI must be ended
+    void SortSweep(uint32_t *regs, uint16_t Points, uint16_t *Order, bool ByRegisters);
+    void SwapSweepPoints(uint32_t *regs, uint16_t *Order, uint16_t PointA, uint16_t PointB);
+    int PrecisionStep(uint16_t ModCandidates, uint32_t CalculationTimeStart, uint32_t CalculationTimeout);
+    void ReadPFDfraction(uint32_t *PFD_Numerator, uint32_t *PFD_Denominator);
+    bool ParseFrequency(char *freq, uint64_t *Frequency); // returns false if out of range
+    uint8_t CalculateRfDivSel(uint64_t Frequency);
+    int WriteFrequencyRegs(uint64_t Frequency, uint32_t ADF4351_N_Int, uint32_t ADF4351_Mod, uint32_t ADF4351_Frac, uint8_t ADF4351_RfDivSel, uint8_t ADF4351_Prescaler, uint8_t PowerLevel, uint8_t AuxPowerLevel, uint8_t AuxFrequencyDivider, bool PrecisionFrequency, uint32_t MaximumFrequencyError, bool WriteToDevice);
+
+};
+
+/*!
+   @brief Statistics for ADF4351PingPong frequency hopping
+
+   Lock times are in uS from prepare() to the first valid lock detect
+   seen by poll() or hop(), so poll() should be called while dwelling on
+   the active channel for these to be the time to lock. A lock seen after
+   the lock deadline is counted as a missed deadline. Hops only counts
+   changeovers of the RF switch. TotalLockTime and MaximumLockTime only
+   include hops which met the lock deadline.
+*/
+struct ADF4351_HopStatistics {
+  uint32_t Hops;
+  uint32_t MissedDeadlines;
+  uint32_t LastLockTime;
+  uint32_t MaximumLockTime;
+  uint32_t TotalLockTime;
+};
+
+/*!
+   @brief Paired ADF4351 chips for frequency hopping without an unlocked gap
+
+   Two ADF4351 chips feed an RF switch. While one outputs the current
+   channel, the other is tuned to the next channel with prepare() and
+   hop() waits for its lock detect before changing over the RF switch,
+   so the hop rate is limited by SPI time rather than lock time.
+
+   Both chips must have been initialized with the lock pin used and
+   programmed once (e.g. with setf) before hopping. The switch pin is
+   LOW for synthesizer A and HIGH for synthesizer B.
+
+   A lock detect which is still HIGH from the previous frequency is not
+   accepted until it has gone LOW or the VCO band selection time has
+   elapsed. If lock was seen after the deadline, the RF switch is still
+   changed over but ADF4351_ERROR_LOCK_TIMEOUT is returned. If there is
+   no lock by the deadline, the RF switch is only changed over if
+   SwitchOnTimeout is true, otherwise the idle synthesizer stays prepared
+   so hop() may be called again.
+*/
+class ADF4351PingPong
+{
+  public:
+    void init(ADF4351 *SynthesizerA, ADF4351 *SynthesizerB, uint8_t SwitchPin);
+    void prepare(const uint32_t *regs); // tune the idle synthesizer (*regs as per WriteSweepValues)
+    bool poll(); // read the idle synthesizer lock detect without waiting to timestamp lock - returns true once locked
+    int hop(uint32_t LockDeadline, bool SwitchOnTimeout); // wait for lock up to LockDeadline uS from prepare() then change over the RF switch
+    ADF4351 *ReadActive();
+    ADF4351 *ReadIdle();
+    void ReadHopStatistics(ADF4351_HopStatistics *Statistics);
+    void ClearHopStatistics();
 
+  private:
+    ADF4351 *ADF4351_Synthesizer[2];
+    uint8_t ADF4351_PIN_SWITCH;
+    uint8_t ADF4351_Active = 0;
+    bool ADF4351_Prepared = false;
+    uint32_t ADF4351_PrepareTime = 0;
+    uint32_t ADF4351_BandSelectTime = 0;
+    bool ADF4351_LockDetectValid = false; // lock detect has gone LOW since prepare()
+    bool ADF4351_Locked = false;
+    uint32_t ADF4351_LockTime = 0; // uS from prepare() to the first valid lock detect seen
+    ADF4351_HopStatistics ADF4351_Statistics;
 };
 
 #endif
\ No newline at end of file